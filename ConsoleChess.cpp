@@ -1,6 +1,7 @@
 /*
  * A simple console program to demonstrate the capabilities of the chess engine
  * To compile, follow the README.md instructions, using ConsoleChess.cpp as the main file
+ * Pass the path of an NNUE network file as argument to have the engine evaluate positions with it
 */
 
 #include "engine/Game.h"
@@ -11,12 +12,20 @@ using namespace std;
 void print_board(ChessGame* game, bool upsidedown);
 void print_help_menu();
 
-int main() {
+int main(int argc, char** argv) {
     int level = 3;
+    // search budget of the engine, 0 for none
+    int time_ms = 0;
+    long long max_nodes = 0;
+    int threads = 1;
     Color player_color = WHITE;
     Color engine_color = BLACK;
     ChessGame game;
     ChessEngine engine(level);
+    if (argc > 1) {
+        if (engine.load_network(argv[1])) cout << "Loaded network " << argv[1] << " (" << Nnue::simd() << ")\n";
+        else cout << "Could not load network " << argv[1] << ", using the hand-written evaluation\n";
+    }
     // used for parsing input
     string cols = "abcdefgh";
     // determines whether we should print the board on next iteration
@@ -38,7 +47,14 @@ int main() {
             if (move.type == PAWN_PROMOTION) {
                 game.promote_pawn(move.move_to, move.promote_to);
             }
-            cout << "Moves considered: " << engine.get_moves_considered() << endl;
+            cout << "Moves considered: " << engine.get_moves_considered() << ", depth reached: " << engine.get_depth_reached()
+                << ", first move cutoffs: " << (int) (100 * engine.get_first_move_cutoff_rate()) << "%" << endl;
+            vector<Move> principal_variation = engine.get_principal_variation();
+            cout << "Principal variation:";
+            for (auto m = principal_variation.begin(); m != principal_variation.end(); m++) {
+                cout << " " << m->as_string();
+            }
+            cout << endl;
             cout << "BLACK MOVE: " << move.as_string() << endl;
             game.next_turn();
             show_board = true;
@@ -57,6 +73,8 @@ int main() {
         } else if (input == "reset") {
             game.reset_game();
             engine.set_level(level);
+            engine.set_limits(SearchLimits(0, time_ms, max_nodes));
+            engine.set_threads(threads);
             engine_color = get_other_color(player_color);
             cout << "Game reset with chess engine level " << engine.get_level() << " and player is " << (char) player_color << "!\n";
             show_board = true;
@@ -88,11 +106,25 @@ int main() {
             show_board = false;
         } else if (input == "settings") {
             cout << "- Player color is: " << (char) player_color << "\n- Chess engine level: " << level << endl;
+            cout << "- Chess engine time limit: " << time_ms << " ms\n- Chess engine node limit: " << max_nodes << endl;
+            cout << "- Chess engine search threads: " << threads << endl;
             show_board = false;
         } else if (input.length() >= 7 && input.substr(0, 6) == "level ") {
             level = stoi(input.substr(6));
             cout << "New chess engine level is " << level << ". Reset game to apply chess engine level.\n";
             show_board = false;
+        } else if (input.length() >= 6 && input.substr(0, 5) == "time ") {
+            time_ms = stoi(input.substr(5));
+            cout << "New chess engine time limit is " << time_ms << " ms. Reset game to apply chess engine time limit.\n";
+            show_board = false;
+        } else if (input.length() >= 7 && input.substr(0, 6) == "nodes ") {
+            max_nodes = stoll(input.substr(6));
+            cout << "New chess engine node limit is " << max_nodes << ". Reset game to apply chess engine node limit.\n";
+            show_board = false;
+        } else if (input.length() >= 9 && input.substr(0, 8) == "threads ") {
+            threads = stoi(input.substr(8));
+            cout << "New chess engine thread count is " << threads << ". Reset game to apply chess engine thread count.\n";
+            show_board = false;
         } else if (input.length() == 7 && input.substr(0, 6) == "color ") {
             if (input[6] == 'w') {
                 player_color = WHITE;
@@ -198,7 +230,10 @@ void print_help_menu() {
     cout << "\tExample: b1 c3 (move piece at b1 to c3)\n";
     cout << "SETTINGS:\n";
     cout << "\tSettings are applied upon game reset\n";
-    cout << "\t- \"level <n>\" to set the chess_engine engine level (0 inclusive). Default is 3\n";
+    cout << "\t- \"level <n>\" to set the chess_engine engine level (0 inclusive), i.e. the maximum search depth. Default is 3\n";
+    cout << "\t- \"time <ms>\" to limit the chess engine's thinking time per move in milliseconds (0 for no limit). Default is 0\n";
+    cout << "\t- \"nodes <n>\" to limit the number of moves the chess engine considers per move (0 for no limit). Default is 0\n";
+    cout << "\t- \"threads <n>\" to set the number of threads the chess engine searches with. Default is 1\n";
     cout << "\t- \"color [w, b]\" to set the player starting color (either w or b). Default is w\n";
     cout << "\t- \"settings\" to show current game settings\n";
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+ * Search benchmark, used to measure the engine's search speed and how it scales with threads
+ * Build with "make bench", then run "_bin/bench help" for usage
+*/
+
+#include "../engine/Game.h"
+#include "../engine/Engine.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+using namespace std;
+
+// positions searched by the benchmark, from the opening to the endgame
+static const char* bench_positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+};
+static const int num_bench_positions = sizeof(bench_positions) / sizeof(bench_positions[0]);
+
+void print_usage();
+
+int main(int argc, char** argv) {
+    int depth = 4;
+    int max_threads = max(1, (int) thread::hardware_concurrency());
+    int hash_mb = DEFAULT_TT_SIZE_MB;
+    int eval_cache_mb = DEFAULT_EVAL_CACHE_SIZE_MB;
+    string network_path = "";
+    ParallelSearch parallel_search = LAZY_SMP;
+    int search_features = ALL_SEARCH_FEATURES;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "help" || arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            max_threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hash_mb = max(1, atoi(argv[++i]));
+        } else if (arg == "--eval-cache" && i + 1 < argc) {
+            eval_cache_mb = max(0, atoi(argv[++i]));
+        } else if (arg == "--nnue" && i + 1 < argc) {
+            network_path = argv[++i];
+        } else if (arg == "--ybwc") {
+            parallel_search = YOUNG_BROTHERS_WAIT;
+        } else if (arg == "--no-nmp") {
+            search_features &= ~NULL_MOVE_PRUNING;
+        } else if (arg == "--no-lmr") {
+            search_features &= ~LATE_MOVE_REDUCTIONS;
+        } else if (arg == "--no-fp") {
+            search_features &= ~FUTILITY_PRUNING;
+        } else if (arg == "--no-rfp") {
+            search_features &= ~REVERSE_FUTILITY_PRUNING;
+        } else {
+            depth = max(1, atoi(arg.c_str()));
+        }
+    }
+
+    if (network_path != "") {
+        Nnue::Network* network = Nnue::load(network_path);
+        if (network == NULL) {
+            cout << "Could not load network " << network_path << endl;
+            return 1;
+        }
+        delete network;
+    }
+
+    vector<int> thread_counts;
+    for (int t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+
+    cout << "Depth " << depth << ", " << num_bench_positions << " positions, " << hash_mb << " MB hash, " << eval_cache_mb << " MB eval cache, "
+        << (network_path != "" ? string("NNUE (") + Nnue::simd() + "), " : string(""))
+        << (parallel_search == LAZY_SMP ? "lazy SMP" : "young brothers wait") << ", search features " << search_features << endl << endl;
+    double single_thread_seconds = 0;
+    for (unsigned t = 0; t < thread_counts.size(); t++) {
+        long long total_nodes = 0;
+        double total_seconds = 0;
+        double cutoff_rate = 0;
+        double pawn_hit_rate = 0;
+        long long eval_hits = 0;
+        long long eval_lookups = 0;
+        for (int p = 0; p < num_bench_positions; p++) {
+            ChessGame game;
+            game.load_fen(bench_positions[p]);
+            // a new engine for every position, so no search starts with results from a previous one
+            ChessEngine engine(depth, hash_mb, parallel_search);
+            engine.set_threads(thread_counts[t]);
+            engine.set_search_features(search_features);
+            engine.set_eval_cache_size(eval_cache_mb);
+            if (network_path != "") engine.load_network(network_path);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            engine.generate_move(game.get_turn(), &game);
+            total_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            total_nodes += engine.get_moves_considered();
+            cutoff_rate += engine.get_first_move_cutoff_rate() / num_bench_positions;
+            pawn_hit_rate += engine.get_pawn_hash_hit_rate() / num_bench_positions;
+            eval_hits += engine.get_eval_cache_hits();
+            eval_lookups += engine.get_eval_cache_hits() + engine.get_eval_cache_misses();
+        }
+        if (t == 0) single_thread_seconds = total_seconds;
+        cout << setw(3) << thread_counts[t] << " thread(s): " << total_nodes << " nodes, time to depth " << fixed << setprecision(3)
+            << total_seconds << " s, " << (long long) (total_seconds > 0 ? total_nodes / total_seconds : 0) << " nodes/second, speedup "
+            << setprecision(2) << (total_seconds > 0 ? single_thread_seconds / total_seconds : 0) << "x, first move cutoffs "
+            << setprecision(1) << 100 * cutoff_rate << "%, eval cache hits "
+            << (eval_lookups > 0 ? 100.0 * eval_hits / eval_lookups : 0) << "%, pawn hash hits " << 100 * pawn_hit_rate << "%" << endl;
+    }
+    return 0;
+}
+
+void print_usage() {
+    cout << "Usage: bench [depth] [--threads <n>] [--hash <mb>] [--eval-cache <mb>] [--nnue <file>] [--ybwc] [--no-nmp] [--no-lmr] [--no-fp] [--no-rfp]\n\n";
+    cout << "Searches a fixed set of positions to the given depth (default 4) with 1, 2, 4, ... up to --threads threads (default: number of cores)\n";
+    cout << "and reports nodes, time to depth, nodes/second and the speedup over a single thread for each thread count, along with the average\n";
+    cout << "share of cutoffs caused by the first move searched at a node (a measure of move ordering quality) and the evaluation cache\n";
+    cout << "and pawn hash hit rates. --hash and --eval-cache set the transposition table and evaluation cache sizes (0 disables the evaluation cache)\n";
+    cout << "--nnue evaluates positions with the network in the given file instead of the hand-written evaluation\n";
+    cout << "--no-nmp, --no-lmr, --no-fp and --no-rfp disable null move pruning, late move reductions, futility pruning and reverse futility pruning\n";
+    cout << "Threads run a lazy SMP search, or a young brothers wait search with --ybwc (whose node counts are the same for every thread count)\n";
+}
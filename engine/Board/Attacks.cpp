@@ -0,0 +1,158 @@
+#include "Attacks.h"
+
+namespace Attacks {
+    Bitboard knight_table[NUM_SQUARES];
+    Bitboard king_table[NUM_SQUARES];
+    Bitboard pawn_table[NUM_COLORS][NUM_SQUARES];
+    Magic bishop_magics[NUM_SQUARES];
+    Magic rook_magics[NUM_SQUARES];
+    Bitboard between_table[NUM_SQUARES][NUM_SQUARES];
+    Bitboard line_table[NUM_SQUARES][NUM_SQUARES];
+
+    // shared attack tables for all squares. Sizes are the sum of 2^(relevant bits) over all squares
+    static Bitboard bishop_table[0x1480];
+    static Bitboard rook_table[0x19000];
+
+    static const int knight_directions[8][2] = { {-2, 1}, {-2, -1}, {-1, 2}, {-1, -2}, {1, 2}, {1, -2}, {2, 1}, {2, -1} };
+    static const int king_directions[8][2] = { {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1} };
+    static const int bishop_directions[4][2] = { {1, 1}, {1, -1}, {-1, -1}, {-1, 1} };
+    static const int rook_directions[4][2] = { {0, 1}, {1, 0}, {0, -1}, {-1, 0} };
+
+    static bool within_boundaries(int x, int y) { return x >= 0 && x < 8 && y >= 0 && y < 8; }
+
+    // Attacks for pieces that move a single step in each direction
+    static Bitboard step_attacks(int square, const int directions[][2], int num_directions) {
+        Bitboard attacks = EMPTY_BB;
+        for (int i = 0; i < num_directions; i++) {
+            int x = square_x(square) + directions[i][0];
+            int y = square_y(square) + directions[i][1];
+            if (within_boundaries(x, y)) attacks |= square_bb(make_square(x, y));
+        }
+        return attacks;
+    }
+
+    Bitboard sliding_attacks(int square, Bitboard occupied, const int directions[][2], int num_directions) {
+        Bitboard attacks = EMPTY_BB;
+        for (int i = 0; i < num_directions; i++) {
+            int x = square_x(square) + directions[i][0];
+            int y = square_y(square) + directions[i][1];
+            while (within_boundaries(x, y)) {
+                Bitboard b = square_bb(make_square(x, y));
+                attacks |= b;
+                if (occupied & b) break;
+                x += directions[i][0];
+                y += directions[i][1];
+            }
+        }
+        return attacks;
+    }
+
+    // Small xorshift generator, so the magics found are the same on every run
+    class MagicRandom {
+    private:
+        uint64_t s;
+    public:
+        MagicRandom(uint64_t seed) : s(seed) {}
+        uint64_t next() {
+            s ^= s >> 12;
+            s ^= s << 25;
+            s ^= s >> 27;
+            return s * 2685821657736338717ULL;
+        }
+        // numbers with few bits set make good magic candidates
+        uint64_t sparse() { return next() & next() & next(); }
+    };
+
+    /*
+     * Fills in the magics and attack table slices for one slider type
+     * For every square, all subsets of the relevant occupancy are enumerated and a magic is searched that maps each of them
+     * to a table entry without destructive collisions
+    */
+    static void build_magics(Magic magics[], Bitboard table[], const int directions[][2]) {
+        Bitboard reference[4096];
+        Bitboard* next_slice = table;
+#ifndef USE_PEXT
+        Bitboard occupancy[4096];
+        // seeds per rank that are known to find magics quickly
+        const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+        int epoch[4096] = {}, current = 0;
+#endif
+
+        for (int square = 0; square < NUM_SQUARES; square++) {
+            Magic& m = magics[square];
+            Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~rank_bb(square_y(square))) | ((FILE_A_BB | FILE_H_BB) & ~file_bb(square_x(square)));
+            m.mask = sliding_attacks(square, EMPTY_BB, directions, 4) & ~edges;
+            m.shift = 64 - pop_count(m.mask);
+            m.attacks = next_slice;
+
+            // enumerate all subsets of the mask (Carry-Rippler trick)
+            int size = 0;
+            Bitboard b = EMPTY_BB;
+            do {
+                reference[size] = sliding_attacks(square, b, directions, 4);
+#ifdef USE_PEXT
+                m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#else
+                occupancy[size] = b;
+#endif
+                size++;
+                b = (b - m.mask) & m.mask;
+            } while (b);
+            next_slice += size;
+
+#ifndef USE_PEXT
+            MagicRandom rng(seeds[square_y(square)]);
+            for (int i = 0; i < size; ) {
+                for (m.magic = 0; pop_count((m.magic * m.mask) >> 56) < 6; ) {
+                    m.magic = rng.sparse();
+                }
+                // epoch marks which table entries were written during the current attempt, so the slice does not need clearing
+                current++;
+                for (i = 0; i < size; i++) {
+                    unsigned idx = m.index(occupancy[i]);
+                    if (epoch[idx] < current) {
+                        epoch[idx] = current;
+                        m.attacks[idx] = reference[i];
+                    } else if (m.attacks[idx] != reference[i]) {
+                        break;
+                    }
+                }
+            }
+#endif
+        }
+    }
+
+    static bool build_tables() {
+        const int white_pawn_directions[2][2] = { {-1, 1}, {1, 1} };
+        const int black_pawn_directions[2][2] = { {-1, -1}, {1, -1} };
+        for (int square = 0; square < NUM_SQUARES; square++) {
+            knight_table[square] = step_attacks(square, knight_directions, 8);
+            king_table[square] = step_attacks(square, king_directions, 8);
+            pawn_table[WHITE_INDEX][square] = step_attacks(square, white_pawn_directions, 2);
+            pawn_table[BLACK_INDEX][square] = step_attacks(square, black_pawn_directions, 2);
+        }
+        build_magics(bishop_magics, bishop_table, bishop_directions);
+        build_magics(rook_magics, rook_table, rook_directions);
+        for (int s1 = 0; s1 < NUM_SQUARES; s1++) {
+            for (int s2 = 0; s2 < NUM_SQUARES; s2++) {
+                between_table[s1][s2] = line_table[s1][s2] = EMPTY_BB;
+                if (s1 == s2) continue;
+                Bitboard b2 = square_bb(s2);
+                if (bishop_attacks(s1, EMPTY_BB) & b2) {
+                    line_table[s1][s2] = (bishop_attacks(s1, EMPTY_BB) & bishop_attacks(s2, EMPTY_BB)) | square_bb(s1) | b2;
+                    between_table[s1][s2] = bishop_attacks(s1, b2) & bishop_attacks(s2, square_bb(s1));
+                } else if (rook_attacks(s1, EMPTY_BB) & b2) {
+                    line_table[s1][s2] = (rook_attacks(s1, EMPTY_BB) & rook_attacks(s2, EMPTY_BB)) | square_bb(s1) | b2;
+                    between_table[s1][s2] = rook_attacks(s1, b2) & rook_attacks(s2, square_bb(s1));
+                }
+            }
+        }
+        return true;
+    }
+
+    void init_attacks() {
+        // function-local statics are initialized exactly once, even with multiple threads
+        static bool initialized = build_tables();
+        (void) initialized;
+    }
+}
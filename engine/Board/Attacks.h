@@ -0,0 +1,79 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "Bitboard.h"
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
+
+/*
+ * Precomputed attack sets for every piece type
+ * Tables are built once per process (see init_attacks) and only read afterwards, so they can be shared between games and engines
+ *
+ * Sliding pieces (bishop, rook, queen) use magic bitboards: the occupancy along a slider's rays is hashed into an index of a table holding
+ * the attack set for that occupancy, so attacks come from a single lookup. When compiled with -DUSE_PEXT (requires BMI2, e.g. -mbmi2),
+ * the PEXT instruction is used for the index instead of the magic multiplication
+*/
+namespace Attacks {
+    /*
+     * Per-square data for a magic bitboard lookup
+    */
+    struct Magic {
+        // relevant occupancy squares, i.e. the rays without the board edges
+        Bitboard mask;
+        Bitboard magic;
+        // start of this square's slice of the shared attack table
+        Bitboard* attacks;
+        unsigned shift;
+
+        unsigned index(Bitboard occupied) const {
+#ifdef USE_PEXT
+            return (unsigned) _pext_u64(occupied, mask);
+#else
+            return (unsigned) (((occupied & mask) * magic) >> shift);
+#endif
+        }
+    };
+
+    extern Bitboard knight_table[NUM_SQUARES];
+    extern Bitboard king_table[NUM_SQUARES];
+    extern Bitboard pawn_table[NUM_COLORS][NUM_SQUARES];
+    extern Magic bishop_magics[NUM_SQUARES];
+    extern Magic rook_magics[NUM_SQUARES];
+    extern Bitboard between_table[NUM_SQUARES][NUM_SQUARES];
+    extern Bitboard line_table[NUM_SQUARES][NUM_SQUARES];
+
+    /*
+     * Builds all attack tables. Safe to call multiple times (and from multiple threads); only the first call does any work
+    */
+    void init_attacks();
+
+    /*
+     * Walks the given ray directions from a square until the edge of the board or the first occupied square (inclusive)
+     * Slow, only used to build the tables
+    */
+    Bitboard sliding_attacks(int square, Bitboard occupied, const int directions[][2], int num_directions);
+}
+
+inline Bitboard knight_attacks(int square) { return Attacks::knight_table[square]; }
+inline Bitboard king_attacks(int square) { return Attacks::king_table[square]; }
+// Squares attacked by a pawn of the given color index standing on square
+inline Bitboard pawn_attacks(int color, int square) { return Attacks::pawn_table[color][square]; }
+
+inline Bitboard bishop_attacks(int square, Bitboard occupied) {
+    const Attacks::Magic& m = Attacks::bishop_magics[square];
+    return m.attacks[m.index(occupied)];
+}
+inline Bitboard rook_attacks(int square, Bitboard occupied) {
+    const Attacks::Magic& m = Attacks::rook_magics[square];
+    return m.attacks[m.index(occupied)];
+}
+inline Bitboard queen_attacks(int square, Bitboard occupied) { return bishop_attacks(square, occupied) | rook_attacks(square, occupied); }
+
+// Squares strictly between two squares on the same rank, file or diagonal, or empty if they are not aligned
+inline Bitboard between_bb(int s1, int s2) { return Attacks::between_table[s1][s2]; }
+// The whole rank, file or diagonal going through both squares, or empty if they are not aligned
+inline Bitboard line_bb(int s1, int s2) { return Attacks::line_table[s1][s2]; }
+
+#endif
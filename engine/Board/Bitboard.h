@@ -0,0 +1,77 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "../Util/Colors.h"
+#include "../Pieces/PieceTypes.h"
+#include <cstdint>
+
+/*
+ * A bitboard is a 64-bit set of board squares
+ * Squares are numbered 0-63 with square = 8 * y + x, i.e. a1 = 0, h1 = 7, a8 = 56, h8 = 63,
+ * which matches the (x, y) coordinates used by Vector
+*/
+typedef uint64_t Bitboard;
+
+#define NUM_SQUARES 64
+#define NO_SQUARE -1
+
+const Bitboard EMPTY_BB = 0ULL;
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard RANK_1_BB = 0xFFULL;
+const Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+inline int make_square(int x, int y) { return 8 * y + x; }
+inline int square_x(int square) { return square & 7; }
+inline int square_y(int square) { return square >> 3; }
+inline Bitboard square_bb(int square) { return 1ULL << square; }
+
+inline Bitboard file_bb(int x) { return FILE_A_BB << x; }
+inline Bitboard rank_bb(int y) { return RANK_1_BB << (8 * y); }
+
+// Number of squares in the set
+inline int pop_count(Bitboard b) { return __builtin_popcountll(b); }
+// Index of the least significant square in the set. The set must not be empty
+inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+// Removes and returns the least significant square in the set. The set must not be empty
+inline int pop_lsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+/*
+ * Colors and piece types are stored as array indices inside the bitboard position
+*/
+#define NUM_COLORS 2
+#define NUM_PIECE_TYPES 6
+
+enum ColorIndex { WHITE_INDEX = 0, BLACK_INDEX = 1 };
+enum PieceIndex { PAWN_INDEX = 0, KNIGHT_INDEX, BISHOP_INDEX, ROOK_INDEX, QUEEN_INDEX, KING_INDEX };
+
+static const PieceType index_piece_types[NUM_PIECE_TYPES] = { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
+
+inline int color_index(Color color) { return color == WHITE ? WHITE_INDEX : BLACK_INDEX; }
+inline Color index_color(int index) { return index == WHITE_INDEX ? WHITE : BLACK; }
+
+inline int piece_index(PieceType type) {
+    switch (type) {
+        case PAWN: return PAWN_INDEX;
+        case KNIGHT: return KNIGHT_INDEX;
+        case BISHOP: return BISHOP_INDEX;
+        case ROOK: return ROOK_INDEX;
+        case QUEEN: return QUEEN_INDEX;
+        case KING: return KING_INDEX;
+        default: return -1;
+    }
+}
+
+inline PieceType index_piece_type(int index) { return index_piece_types[index]; }
+
+// Squares attacked by a set of pawns of the color index, all at once
+inline Bitboard pawn_attacks_bb(int color, Bitboard pawns) {
+    if (color == WHITE_INDEX) return ((pawns & ~FILE_A_BB) << 7) | ((pawns & ~FILE_H_BB) << 9);
+    return ((pawns & ~FILE_A_BB) >> 9) | ((pawns & ~FILE_H_BB) >> 7);
+}
+
+#endif
@@ -12,6 +12,7 @@
 #include "../Pieces/Bishop.h"
 #include "../Pieces/King.h"
 #include "../Pieces/Queen.h"
+#include "Position.h"
 
 #include <unordered_map>
 using std::unordered_map;
@@ -19,64 +20,105 @@ using std::pair;
 
 /*
  * Class that keeps track of a chessboard state
- * 
+ *
+ * The actual board state lives in a bitboard Position, which is what move generation and search run on.
+ * Board is a thin adapter over it that keeps a Piece* for every occupied square, for the front-ends that work with Piece objects
+ *
  * Initializes as a standard 8x8 chessboard with all pieces at standard positions
 */
 class Board {
 private:
     Piece* board[BOARD_SIZE][BOARD_SIZE];
-    string REG_PIECES = "NK";
-    string FAST_PIECES = "RBQ";
+    Position position;
 
-    // allow for quicker querying
-    unordered_map<string, Piece*> white_pieces;
-    unordered_map<string, Piece*> black_pieces;
-    Piece* white_king;
-    Piece* black_king;
+    // used for memory management. Every piece ever placed on the board is owned by the board,
+    // since pieces that left the board can still be referenced by the move history
+    vector<Piece*> owned_pieces;
+    // pieces nothing refers to anymore (see release_piece), by piece index. create_piece hands them out again instead of allocating
+    vector<Piece*> piece_pool[NUM_PIECE_TYPES];
 
-    // used for memory management
-    unordered_map<string, Piece*> deleted_pieces;
+    void adopt_piece(Piece* piece) {
+        for (auto p = owned_pieces.begin(); p != owned_pieces.end(); p++) {
+            if (*p == piece) return;
+        }
+        owned_pieces.push_back(piece);
+    }
 
-public:
-    Board() {
-        white_pieces.reserve(16);
-        black_pieces.reserve(16);
-        for (int x = 0; x < 8; x++) {
-            for (int y = 0; y < 8; y++) {
+    // creates a Piece for every piece on the position
+    void build_view() {
+        for (int x = 0; x < BOARD_SIZE; x++) {
+            for (int y = 0; y < BOARD_SIZE; y++) {
                 board[x][y] = NULL;
-            }
-        }
-        for (int y = 0; y < 8; y += 7) {
-            Color color = y < 4 ? WHITE : BLACK;
-            if (y == 0 || y == 7) {
-                board[0][y] = new Rook(color, Vector(0, y));
-                board[1][y] = new Knight(color, Vector(1, y));
-                board[2][y] = new Bishop(color, Vector(2, y));
-                board[3][y] = new Queen(color, Vector(3, y));
-                board[4][y] = new King(color, Vector(4, y));
-                board[5][y] = new Bishop(color, Vector(5, y));
-                board[6][y] = new Knight(color, Vector(6, y));
-                board[7][y] = new Rook(color, Vector(7, y));
-                for (int x = 0; x < 8; x++) {
-                    if (color == WHITE) {
-                        white_pieces.insert(pair<string, Piece*>(board[x][y]->get_id(), board[x][y]));
-                    } else {
-                        black_pieces.insert(pair<string, Piece*>(board[x][y]->get_id(), board[x][y]));
-                    }
-                }
-                int i = y == 0 ? 1 : 6;
-                for (int x = 0; x < 8; x++) {
-                    board[x][i] = new Pawn(color, Vector(x, i));
-                    if (color == WHITE) {
-                        white_pieces.insert(pair<string, Piece*>(board[x][i]->get_id(), board[x][i]));
-                    } else {
-                        black_pieces.insert(pair<string, Piece*>(board[x][i]->get_id(), board[x][i]));
-                    }
+                int piece = position.piece_on(make_square(x, y));
+                if (piece != NO_PIECE) {
+                    board[x][y] = create_piece(
+                        index_piece_type(Position::piece_type(piece)), index_color(Position::piece_color(piece)), Vector(x, y)
+                    );
                 }
             }
         }
-        white_king = board[4][0];
-        black_king = board[4][7];
+    }
+
+public:
+    Board() { build_view(); }
+    /*
+     * Initializes the board from a FEN string. If the FEN is invalid, the board is left empty
+    */
+    Board(const string& fen) {
+        position.set_fen(fen);
+        build_view();
+    }
+    // Initializes the board as a copy of the given position
+    Board(const Position& position) : position(position) { build_view(); }
+
+    /*
+     * Creates a new piece of the given type, reusing a released piece of that type if there is one. The board takes care of its memory
+    */
+    Piece* create_piece(PieceType type, Color color, Vector pos) {
+        int index = piece_index(type);
+        if (index >= 0 && !piece_pool[index].empty()) {
+            Piece* piece = piece_pool[index].back();
+            piece_pool[index].pop_back();
+            piece->color = color;
+            piece->position = pos;
+            piece->has_moved = false;
+            return piece;
+        }
+        Piece* piece;
+        switch (type) {
+            case PAWN: piece = new Pawn(color, pos); break;
+            case KNIGHT: piece = new Knight(color, pos); break;
+            case BISHOP: piece = new Bishop(color, pos); break;
+            case ROOK: piece = new Rook(color, pos); break;
+            case QUEEN: piece = new Queen(color, pos); break;
+            case KING: piece = new King(color, pos); break;
+            default: return NULL;
+        }
+        owned_pieces.push_back(piece);
+        return piece;
+    }
+
+    /*
+     * Gives a piece back to the board once nothing refers to it anymore, i.e. it is neither on the board nor in a move history
+     * (e.g. the piece a pawn was promoted to, once the promotion is undone). create_piece hands it out again later
+    */
+    void release_piece(Piece* piece) { piece_pool[piece_index(piece->type)].push_back(piece); }
+
+    // Returns the bitboard position the board is built on
+    Position& get_position() { return position; }
+
+    /*
+     * Replaces the board with a copy of the given position. The pieces on the board are released and reused for the new position,
+     * so the caller must not refer to them anymore
+    */
+    void set_position(const Position& new_position) {
+        Bitboard occupied = position.get_occupied();
+        while (occupied) {
+            int square = pop_lsb(occupied);
+            release_piece(board[square_x(square)][square_y(square)]);
+        }
+        position = new_position;
+        build_view();
     }
 
     /*
@@ -86,10 +128,12 @@ public:
     Piece* get_piece(Vector v) { return get_piece(v.x, v.y); }
     Piece* get_piece(int x, int y) { return within_boundaries(x, y) ? board[x][y] : NULL; }
     Piece* get_piece(string piece_id) {
-        auto p = white_pieces.find(piece_id);
-        if (p != white_pieces.end()) return p->second;
-        p = black_pieces.find(piece_id);
-        if (p != white_pieces.end()) return p->second;
+        Bitboard occupied = position.get_occupied();
+        while (occupied) {
+            int square = pop_lsb(occupied);
+            Piece* p = board[square_x(square)][square_y(square)];
+            if (p->get_id() == piece_id) return p;
+        }
         return NULL;
     }
 
@@ -100,34 +144,11 @@ public:
     */
     Piece* replace_piece(Vector v, Piece* piece) { return replace_piece(v.x, v.y, piece); }
     Piece* replace_piece(int x, int y, Piece* piece) {
-        if (within_boundaries(x, y)) {
-            Piece* replaced = board[x][y];
-            board[x][y] = piece;
-            if (piece != NULL) {
-                piece->position.set(x, y);
-                if (piece->color == WHITE) {
-                    white_pieces.insert(pair<string, Piece*>(piece->get_id(), piece));
-                    if (piece->type == KING) {
-                        white_king = piece;
-                    }
-                } else {
-                    black_pieces.insert(pair<string, Piece*>(piece->get_id(), piece));
-                    if (piece->type == KING) {
-                        black_king = piece;
-                    }
-                }
-                deleted_pieces.erase(piece->get_id());
-                if (replaced != NULL && replaced->get_id() != piece->get_id()) {
-                    if (replaced->color == WHITE) {
-                        white_pieces.erase(replaced->get_id());
-                    } else {
-                        black_pieces.erase(replaced->get_id());
-                    }
-                    deleted_pieces.insert(pair<string, Piece*>(replaced->get_id(), replaced));
-                }
-            }
-            return replaced;
-        } else return NULL;
+        if (!within_boundaries(x, y)) return NULL;
+        if (piece == NULL) return clear_piece(x, y);
+        adopt_piece(piece);
+        position.set_piece(make_square(x, y), piece->color, piece->type);
+        return set_view(make_square(x, y), piece);
     }
 
     /*
@@ -138,21 +159,39 @@ public:
     Piece* clear_piece(Vector v) { return clear_piece(v.x, v.y); }
     Piece* clear_piece(int x, int y) {
         if (!within_boundaries(x, y)) return NULL;
-        Piece* cleared = board[x][y];
-        board[x][y] = NULL;
-        return cleared;
+        position.clear_square(make_square(x, y));
+        return set_view(make_square(x, y), NULL);
+    }
+
+    /*
+     * Updates only the Piece* shown on a square, without touching the position. Used to mirror moves already made on the position
+     * Returns the piece that was shown there before
+    */
+    Piece* set_view(int square, Piece* piece) {
+        Piece* replaced = board[square_x(square)][square_y(square)];
+        board[square_x(square)][square_y(square)] = piece;
+        if (piece != NULL) piece->position.set(square_x(square), square_y(square));
+        return replaced;
+    }
+    // Moves the Piece* shown on square from to square to, returning the piece previously shown on to
+    Piece* move_view(int from, int to) {
+        Piece* replaced = set_view(to, board[square_x(from)][square_y(from)]);
+        board[square_x(from)][square_y(from)] = NULL;
+        return replaced;
     }
 
     Piece* get_king(Color color) {
-        return color == WHITE ? white_king : black_king;
+        int square = position.king_square(color_index(color));
+        return square == NO_SQUARE ? NULL : board[square_x(square)][square_y(square)];
     }
 
     vector<Piece*> get_pieces(Color color) {
         vector<Piece*> pieces;
-        auto start = color == WHITE ? white_pieces.begin() : black_pieces.begin();
-        auto end = color == WHITE ? white_pieces.end() : black_pieces.end();
-        for (auto p = start; p != end; p++) {
-            pieces.push_back(p->second);
+        Bitboard occupancy = position.get_occupancy(color_index(color));
+        pieces.reserve(pop_count(occupancy));
+        while (occupancy) {
+            int square = pop_lsb(occupancy);
+            pieces.push_back(board[square_x(square)][square_y(square)]);
         }
         return pieces;
     }
@@ -166,13 +205,8 @@ public:
     }
 
     ~Board() {
-        for (int x = 0; x < 8; x++) {
-            for (int y = 0; y < 8; y++) {
-                delete board[x][y];
-            }
-        }
-        for (auto p = deleted_pieces.begin(); p != deleted_pieces.end(); p++) {
-            delete p->second;
+        for (auto p = owned_pieces.begin(); p != owned_pieces.end(); p++) {
+            delete *p;
         }
     }
 };
@@ -0,0 +1,169 @@
+#include "Evaluation.h"
+#include "Position.h"
+#include "../Pieces/Pawn.h"
+#include "../Pieces/Knight.h"
+#include "../Pieces/Bishop.h"
+#include "../Pieces/Rook.h"
+#include "../Pieces/Queen.h"
+#include "../Pieces/King.h"
+
+namespace Evaluation {
+    int piece_square[NUM_PHASES][NUM_COLORS][NUM_PIECE_TYPES][NUM_SQUARES];
+    int piece_values[NUM_PIECE_TYPES];
+    int material_values[NUM_PIECE_TYPES];
+
+    // pawn structure terms for each game phase, on the evaluation scale (a pawn is worth 70)
+    static const int doubled_pawn[NUM_PHASES] = { -10, -20 };
+    static const int isolated_pawn[NUM_PHASES] = { -10, -15 };
+    static const int backward_pawn[NUM_PHASES] = { -8, -10 };
+    // by rank, counted from the pawn's own side
+    static const int passed_pawn[NUM_PHASES][8] = {
+        { 0, 5, 10, 15, 25, 40, 60, 0 },
+        { 0, 10, 15, 25, 40, 65, 100, 0 }
+    };
+
+    // score for each square a piece index can safely move to, for each game phase
+    static const int mobility_bonus[NUM_PHASES][NUM_PIECE_TYPES] = {
+        { 0, 3, 3, 2, 1, 0 },
+        { 0, 3, 4, 4, 2, 0 }
+    };
+    // attack units of each piece index for each square of the enemy king zone it attacks, and the largest king safety penalty
+    static const int king_attack_units[NUM_PIECE_TYPES] = { 0, 2, 2, 3, 5, 0 };
+    static const int max_king_danger = 250;
+
+    static Bitboard adjacent_files_bb(int x) {
+        return (x > 0 ? file_bb(x - 1) : EMPTY_BB) | (x < 7 ? file_bb(x + 1) : EMPTY_BB);
+    }
+
+    // ranks in front of rank y, as seen from the color index
+    static Bitboard forward_ranks_bb(int color, int y) {
+        if (color == WHITE_INDEX) return y < 7 ? ~EMPTY_BB << (8 * (y + 1)) : EMPTY_BB;
+        return (1ULL << (8 * y)) - 1;
+    }
+
+    void evaluate_pawns(const Position& position, int scores[NUM_PHASES]) {
+        for (int phase = 0; phase < NUM_PHASES; phase++) {
+            scores[phase] = 0;
+        }
+        for (int color = 0; color < NUM_COLORS; color++) {
+            int sign = color == WHITE_INDEX ? 1 : -1;
+            Bitboard own = position.get_pieces(color, PAWN_INDEX);
+            Bitboard enemies = position.get_pieces(color ^ 1, PAWN_INDEX);
+            Bitboard pawns = own;
+            while (pawns) {
+                int square = pop_lsb(pawns);
+                int x = square_x(square), y = square_y(square);
+                Bitboard ahead = forward_ranks_bb(color, y);
+                Bitboard neighbours = own & adjacent_files_bb(x);
+                // only the rearmost pawns of a file count as doubled, and only the frontmost one can be passed
+                bool doubled = (own & file_bb(x) & ahead) != EMPTY_BB;
+                bool isolated = neighbours == EMPTY_BB;
+                bool passed = !doubled && !(enemies & (file_bb(x) | adjacent_files_bb(x)) & ahead);
+                // no neighbour level with or behind it to support its advance, and the square in front of it is attacked by an enemy pawn
+                int stop = color == WHITE_INDEX ? square + 8 : square - 8;
+                bool backward = !isolated && !(neighbours & ~ahead) && stop >= 0 && stop < NUM_SQUARES
+                    && (pawn_attacks(color, stop) & enemies);
+                int rank = color == WHITE_INDEX ? y : 7 - y;
+                for (int phase = 0; phase < NUM_PHASES; phase++) {
+                    int score = 0;
+                    if (doubled) score += doubled_pawn[phase];
+                    if (isolated) score += isolated_pawn[phase];
+                    if (backward) score += backward_pawn[phase];
+                    if (passed) score += passed_pawn[phase][rank];
+                    scores[phase] += sign * score;
+                }
+            }
+        }
+    }
+
+    Bitboard piece_attacks(const Position& position, int square) {
+        int piece = position.piece_on(square);
+        switch (Position::piece_type(piece)) {
+            case PAWN_INDEX: return pawn_attacks(Position::piece_color(piece), square);
+            case KNIGHT_INDEX: return knight_attacks(square);
+            case BISHOP_INDEX: return bishop_attacks(square, position.get_occupied());
+            case ROOK_INDEX: return rook_attacks(square, position.get_occupied());
+            case QUEEN_INDEX: return queen_attacks(square, position.get_occupied());
+            default: return king_attacks(square);
+        }
+    }
+
+    int mobility(const Position& position, int square) {
+        int color = Position::piece_color(position.piece_on(square));
+        return pop_count(piece_attacks(position, square) & ~position.get_occupancy(color));
+    }
+
+    void evaluate_pieces(const Position& position, int scores[NUM_PHASES]) {
+        Bitboard occupied = position.get_occupied();
+        for (int phase = 0; phase < NUM_PHASES; phase++) {
+            scores[phase] = 0;
+        }
+        for (int color = 0; color < NUM_COLORS; color++) {
+            int sign = color == WHITE_INDEX ? 1 : -1;
+            int them = color ^ 1;
+            Bitboard safe = ~(position.get_occupancy(color) | pawn_attacks_bb(them, position.get_pieces(them, PAWN_INDEX)));
+            int enemy_king = position.king_square(them);
+            Bitboard king_zone = enemy_king == NO_SQUARE ? EMPTY_BB : king_attacks(enemy_king) | square_bb(enemy_king);
+            int attackers = 0, attack_units = 0;
+            for (int type = KNIGHT_INDEX; type <= QUEEN_INDEX; type++) {
+                Bitboard pieces = position.get_pieces(color, type);
+                while (pieces) {
+                    int square = pop_lsb(pieces);
+                    Bitboard attacks = type == KNIGHT_INDEX ? knight_attacks(square)
+                        : type == BISHOP_INDEX ? bishop_attacks(square, occupied)
+                        : type == ROOK_INDEX ? rook_attacks(square, occupied)
+                        : queen_attacks(square, occupied);
+                    int moves = pop_count(attacks & safe);
+                    for (int phase = 0; phase < NUM_PHASES; phase++) {
+                        scores[phase] += sign * mobility_bonus[phase][type] * moves;
+                    }
+                    Bitboard zone_attacks = attacks & king_zone;
+                    if (zone_attacks) {
+                        attackers++;
+                        attack_units += king_attack_units[type] * pop_count(zone_attacks);
+                    }
+                }
+            }
+            // a single attacker is rarely dangerous. King safety matters less as pieces come off, so it is a middlegame term only
+            if (attackers >= 2) {
+                int danger = attack_units * attack_units / 3;
+                scores[MIDDLEGAME] += sign * (danger < max_king_danger ? danger : max_king_danger);
+            }
+        }
+    }
+
+    static Piece* make_piece(int color, int type) {
+        Color c = index_color(color);
+        switch (index_piece_type(type)) {
+            case PAWN: return new Pawn(c, Vector());
+            case KNIGHT: return new Knight(c, Vector());
+            case BISHOP: return new Bishop(c, Vector());
+            case ROOK: return new Rook(c, Vector());
+            case QUEEN: return new Queen(c, Vector());
+            default: return new King(c, Vector());
+        }
+    }
+
+    static bool build_tables() {
+        for (int c = 0; c < NUM_COLORS; c++) {
+            for (int t = 0; t < NUM_PIECE_TYPES; t++) {
+                Piece* piece = make_piece(c, t);
+                material_values[t] = t == KING_INDEX ? 0 : piece->get_material_value();
+                piece_values[t] = 7 * material_values[t];
+                for (int s = 0; s < NUM_SQUARES; s++) {
+                    for (int phase = 0; phase < NUM_PHASES; phase++) {
+                        int table_value = piece->get_square_table_value(square_x(s), square_y(s), phase == ENDGAME);
+                        piece_square[phase][c][t][s] = piece_values[t] + 3 * table_value / 2;
+                    }
+                }
+                delete piece;
+            }
+        }
+        return true;
+    }
+
+    void init_evaluation() {
+        static bool initialized = build_tables();
+        (void) initialized;
+    }
+}
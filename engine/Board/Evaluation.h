@@ -0,0 +1,65 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "Bitboard.h"
+
+class Position;
+
+/*
+ * Piece values and piece-square tables used by the incremental evaluation of Position
+ * Scores use the same scale as ChessEngine::calculate_utility: 7 times the material value of the piece (so a pawn is worth 70) plus 1.5 times
+ * its piece-square table value (https://www.chessprogramming.org/Simplified_Evaluation_Function). The tables are taken from the Piece classes
+*/
+namespace Evaluation {
+    // Middlegame and endgame tables. Only the king has a separate endgame table
+    enum GamePhase { MIDDLEGAME = 0, ENDGAME = 1, NUM_PHASES = 2 };
+
+    /*
+     * The game phase is the sum of phase_weights over all non-pawn pieces on the board, from TOTAL_PHASE with all of them (middlegame)
+     * down to 0 with only kings and pawns (endgame). Promotions can push it above TOTAL_PHASE
+    */
+    const int TOTAL_PHASE = 24;
+    const int phase_weights[NUM_PIECE_TYPES] = { 0, 1, 1, 2, 4, 0 };
+
+    /*
+     * Interpolates between a middlegame and an endgame score by game phase (https://www.chessprogramming.org/Tapered_Eval),
+     * so that scores change gradually as pieces come off the board
+    */
+    inline int taper(int middlegame, int endgame, int phase) {
+        if (phase > TOTAL_PHASE) phase = TOTAL_PHASE;
+        return (middlegame * phase + endgame * (TOTAL_PHASE - phase)) / TOTAL_PHASE;
+    }
+
+    // score of a piece of a color index and piece index on a square, including its material value (kings have none)
+    extern int piece_square[NUM_PHASES][NUM_COLORS][NUM_PIECE_TYPES][NUM_SQUARES];
+    // material value of each piece index on the evaluation scale
+    extern int piece_values[NUM_PIECE_TYPES];
+    // material value of each piece index as given by Piece::get_material_value (10 for a pawn), with kings worth nothing
+    extern int material_values[NUM_PIECE_TYPES];
+
+    /*
+     * Scores the pawn structure of the position for each game phase, WHITE's minus BLACK's: doubled, isolated and backward pawns are
+     * penalized, and passed pawns get a bonus growing as they advance (https://www.chessprogramming.org/Pawn_Structure)
+     * Only depends on where the pawns are, so results can be cached by pawn key (see Position::get_pawn_key and PawnHashTable)
+    */
+    void evaluate_pawns(const Position& position, int scores[NUM_PHASES]);
+
+    /*
+     * Scores mobility and king safety for each game phase, WHITE's minus BLACK's, in one pass over the knights, bishops, rooks and queens
+     * Mobility counts the squares a piece attacks that are neither taken by its own pieces nor attacked by enemy pawns. King safety penalizes
+     * a king whose surrounding squares are attacked by at least two enemy pieces, growing with the number and weight of the attacks
+     * (https://www.chessprogramming.org/King_Safety#Attacking_King_Zone). Both come from attack bitboards and popcounts
+    */
+    void evaluate_pieces(const Position& position, int scores[NUM_PHASES]);
+    // Returns the squares attacked by the piece on square (which must not be empty)
+    Bitboard piece_attacks(const Position& position, int square);
+    // Returns the number of squares attacked by the piece on square that are not taken by its own pieces
+    int mobility(const Position& position, int square);
+
+    /*
+     * Builds the tables. Safe to call multiple times (and from multiple threads); only the first call does any work
+    */
+    void init_evaluation();
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "MoveGen.h"
+
+// Adds a move to every target square, flagging moves onto the last rank as promotions
+static void add_moves(MoveList& moves, int from, Bitboard targets, bool pawn) {
+    while (targets) {
+        int to = pop_lsb(targets);
+        bool promotion = pawn && (square_y(to) == 0 || square_y(to) == 7);
+        moves.push_back(BoardMove(from, to, promotion ? PROMOTION_MOVE : NORMAL_MOVE));
+    }
+}
+
+// Checks if an en passant capture would leave the king attacked, e.g. when both pawns leave a rank shared by the king and an enemy rook
+static bool en_passant_exposes_king(const Position& position, int color, int king, int from, int to) {
+    if (king == NO_SQUARE) return false;
+    int them = color ^ 1;
+    int captured = make_square(square_x(to), square_y(from));
+    Bitboard occupied = (position.get_occupied() ^ square_bb(from) ^ square_bb(captured)) | square_bb(to);
+    Bitboard queens = position.get_pieces(them, QUEEN_INDEX);
+    return (rook_attacks(king, occupied) & (position.get_pieces(them, ROOK_INDEX) | queens))
+        || (bishop_attacks(king, occupied) & (position.get_pieces(them, BISHOP_INDEX) | queens))
+        || (knight_attacks(king) & position.get_pieces(them, KNIGHT_INDEX))
+        || (pawn_attacks(color, king) & position.get_pieces(them, PAWN_INDEX) & ~square_bb(captured));
+}
+
+void generate_legal_moves(const Position& position, int color, MoveList& moves, Bitboard from_mask) {
+    int them = color ^ 1;
+    Bitboard own = position.get_occupancy(color);
+    Bitboard enemies = position.get_occupancy(them);
+    Bitboard occupied = position.get_occupied();
+    int king = position.king_square(color);
+
+    Bitboard checkers = EMPTY_BB, pinned = EMPTY_BB;
+    // squares non-king pieces may move to: anywhere, or when in check, onto the checker or in between it and the king
+    Bitboard check_mask = ~EMPTY_BB;
+    if (king != NO_SQUARE) {
+        checkers = position.attackers_to(king, occupied) & enemies;
+        Bitboard enemy_queens = position.get_pieces(them, QUEEN_INDEX);
+        Bitboard snipers = (rook_attacks(king, EMPTY_BB) & (position.get_pieces(them, ROOK_INDEX) | enemy_queens))
+            | (bishop_attacks(king, EMPTY_BB) & (position.get_pieces(them, BISHOP_INDEX) | enemy_queens));
+        while (snipers) {
+            int sniper = pop_lsb(snipers);
+            Bitboard blockers = between_bb(king, sniper) & occupied;
+            if (pop_count(blockers) == 1 && (blockers & own)) pinned |= blockers;
+        }
+        if (checkers) check_mask = between_bb(king, lsb(checkers)) | checkers;
+
+        if (from_mask & square_bb(king)) {
+            // the king itself must not stay on the checking slider's ray, so it is removed from the blockers
+            Bitboard targets = king_attacks(king) & ~own;
+            Bitboard without_king = occupied ^ square_bb(king);
+            while (targets) {
+                int to = pop_lsb(targets);
+                if (!position.is_attacked(to, them, without_king)) moves.push_back(BoardMove(king, to));
+            }
+            // castling: not out of, through or into check, and nothing in between king and rook
+            int row = color == WHITE_INDEX ? 0 : 7;
+            int rights = position.get_castling_rights();
+            Bitboard rooks = position.get_pieces(color, ROOK_INDEX);
+            if (!checkers && king == make_square(4, row)) {
+                if ((rights & (color == WHITE_INDEX ? WHITE_KINGSIDE : BLACK_KINGSIDE))
+                    && (rooks & square_bb(make_square(7, row)))
+                    && !(between_bb(king, make_square(7, row)) & occupied)
+                    && !position.is_attacked(make_square(5, row), them) && !position.is_attacked(make_square(6, row), them)) {
+                    moves.push_back(BoardMove(king, make_square(6, row), CASTLE_MOVE));
+                }
+                if ((rights & (color == WHITE_INDEX ? WHITE_QUEENSIDE : BLACK_QUEENSIDE))
+                    && (rooks & square_bb(make_square(0, row)))
+                    && !(between_bb(king, make_square(0, row)) & occupied)
+                    && !position.is_attacked(make_square(3, row), them) && !position.is_attacked(make_square(2, row), them)) {
+                    moves.push_back(BoardMove(king, make_square(2, row), CASTLE_MOVE));
+                }
+            }
+        }
+        // in double check, only the king can move
+        if (pop_count(checkers) > 1) return;
+    }
+
+    Bitboard movable = own & from_mask & ~position.get_pieces(color, KING_INDEX);
+
+    // pawns
+    Bitboard pawns = position.get_pieces(color, PAWN_INDEX) & movable;
+    int forward = color == WHITE_INDEX ? 8 : -8;
+    int start_row = color == WHITE_INDEX ? 1 : 6;
+    int en_passant = position.get_en_passant_square();
+    // the en passant square is only usable by the color that did not just move the pawn
+    if (en_passant != NO_SQUARE && square_y(en_passant) != (color == WHITE_INDEX ? 5 : 2)) en_passant = NO_SQUARE;
+    while (pawns) {
+        int from = pop_lsb(pawns);
+        Bitboard pin_mask = (pinned & square_bb(from)) ? line_bb(king, from) : ~EMPTY_BB;
+        Bitboard targets = pawn_attacks(color, from) & enemies;
+        int to = from + forward;
+        if (to >= 0 && to < NUM_SQUARES && position.is_empty(to)) {
+            targets |= square_bb(to);
+            if (square_y(from) == start_row && position.is_empty(to + forward)) targets |= square_bb(to + forward);
+        }
+        add_moves(moves, from, targets & check_mask & pin_mask, true);
+
+        if (en_passant != NO_SQUARE && (pawn_attacks(color, from) & square_bb(en_passant))) {
+            if (!en_passant_exposes_king(position, color, king, from, en_passant)) {
+                moves.push_back(BoardMove(from, en_passant, EN_PASSANT_MOVE));
+            }
+        }
+    }
+
+    // pieces
+    for (int type = KNIGHT_INDEX; type <= QUEEN_INDEX; type++) {
+        Bitboard pieces = position.get_pieces(color, type) & movable;
+        while (pieces) {
+            int from = pop_lsb(pieces);
+            Bitboard targets;
+            switch (type) {
+                case KNIGHT_INDEX: targets = knight_attacks(from); break;
+                case BISHOP_INDEX: targets = bishop_attacks(from, occupied); break;
+                case ROOK_INDEX: targets = rook_attacks(from, occupied); break;
+                default: targets = queen_attacks(from, occupied); break;
+            }
+            targets &= ~own & check_mask;
+            // pinned pieces can only move along the line between king and pinner
+            if (pinned & square_bb(from)) targets &= line_bb(king, from);
+            add_moves(moves, from, targets, false);
+        }
+    }
+}
+
+bool has_legal_moves(const Position& position, int color) {
+    MoveList moves;
+    generate_legal_moves(position, color, moves);
+    return !moves.empty();
+}
@@ -0,0 +1,49 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "Position.h"
+
+/*
+ * Legal move generation on a bitboard Position
+ *
+ * Pinned pieces and the check evasion mask are computed once per position, so every generated move is legal without having to make it
+ * and test for check afterwards. Pawn promotions are generated once per destination with promote_to set to NONE, i.e. as pending promotions
+*/
+
+// Most moves a list can hold. No legal chess position has more than 218 moves, even with every promotion piece counted separately
+#define MAX_MOVES 256
+
+/*
+ * Fixed capacity list of moves, meant to live on the stack of whoever generates the moves so that move generation never allocates
+ * Capacity is not checked on push_back
+*/
+struct MoveList {
+    BoardMove moves[MAX_MOVES];
+    int count;
+
+    MoveList() : count(0) {}
+
+    void push_back(BoardMove m) { moves[count++] = m; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    BoardMove& operator[](int i) { return moves[i]; }
+    const BoardMove& operator[](int i) const { return moves[i]; }
+    BoardMove* begin() { return moves; }
+    BoardMove* end() { return moves + count; }
+    const BoardMove* begin() const { return moves; }
+    const BoardMove* end() const { return moves + count; }
+};
+
+/*
+ * Appends all legal moves of the given color index to moves
+ * Only pieces standing on a square in from_mask are considered (all of them by default)
+*/
+void generate_legal_moves(const Position& position, int color, MoveList& moves, Bitboard from_mask = ~EMPTY_BB);
+
+/*
+ * Checks if the given color index has at least one legal move
+*/
+bool has_legal_moves(const Position& position, int color);
+
+#endif
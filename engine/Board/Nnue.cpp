@@ -0,0 +1,185 @@
+#include "Nnue.h"
+#include "Evaluation.h"
+#include <fstream>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace Nnue {
+    template <typename T>
+    static bool read_values(std::ifstream& file, T* values, size_t count) {
+        // stored little endian, like the hosts the engine runs on
+        file.read(reinterpret_cast<char*>(values), sizeof(T) * count);
+        return (size_t) file.gcount() == sizeof(T) * count;
+    }
+
+    Network* load(const string& path) {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file) return NULL;
+        char magic[4];
+        uint32_t inputs, hidden;
+        if (!read_values(file, magic, 4) || memcmp(magic, "CNUE", 4) != 0) return NULL;
+        if (!read_values(file, &inputs, 1) || !read_values(file, &hidden, 1)) return NULL;
+        if (inputs != NNUE_INPUTS || hidden != NNUE_HIDDEN) return NULL;
+        Network* network = new Network();
+        if (!read_values(file, network->feature_weights, NNUE_INPUTS * NNUE_HIDDEN)
+            || !read_values(file, network->feature_biases, NNUE_HIDDEN)
+            || !read_values(file, network->output_weights, 2 * NNUE_HIDDEN)
+            || !read_values(file, &network->output_bias, 1)
+            || file.peek() != EOF) {
+            delete network;
+            return NULL;
+        }
+        return network;
+    }
+
+    void reset(const Network& network, int16_t* accumulator) {
+        memcpy(accumulator, network.feature_biases, sizeof(network.feature_biases));
+    }
+
+#if defined(__AVX2__)
+
+    void add_feature(const Network& network, int16_t* accumulator, int feature) {
+        const int16_t* weights = &network.feature_weights[feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) &accumulator[i]);
+            __m256i w = _mm256_loadu_si256((const __m256i*) &weights[i]);
+            _mm256_storeu_si256((__m256i*) &accumulator[i], _mm256_add_epi16(a, w));
+        }
+    }
+
+    void remove_feature(const Network& network, int16_t* accumulator, int feature) {
+        const int16_t* weights = &network.feature_weights[feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) &accumulator[i]);
+            __m256i w = _mm256_loadu_si256((const __m256i*) &weights[i]);
+            _mm256_storeu_si256((__m256i*) &accumulator[i], _mm256_sub_epi16(a, w));
+        }
+    }
+
+    void move_feature(const Network& network, int16_t* accumulator, int from_feature, int to_feature) {
+        const int16_t* from_weights = &network.feature_weights[from_feature * NNUE_HIDDEN];
+        const int16_t* to_weights = &network.feature_weights[to_feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) &accumulator[i]);
+            a = _mm256_sub_epi16(a, _mm256_loadu_si256((const __m256i*) &from_weights[i]));
+            a = _mm256_add_epi16(a, _mm256_loadu_si256((const __m256i*) &to_weights[i]));
+            _mm256_storeu_si256((__m256i*) &accumulator[i], a);
+        }
+    }
+
+    // sum of clamp(accumulator, 0, QA) * weights
+    static int32_t clipped_dot(const int16_t* accumulator, const int16_t* weights) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i qa = _mm256_set1_epi16(QA);
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*) &accumulator[i]);
+            a = _mm256_min_epi16(_mm256_max_epi16(a, zero), qa);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_loadu_si256((const __m256i*) &weights[i])));
+        }
+        __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum128);
+    }
+
+    const char* simd() { return "AVX2"; }
+
+#elif defined(__SSE4_1__)
+
+    void add_feature(const Network& network, int16_t* accumulator, int feature) {
+        const int16_t* weights = &network.feature_weights[feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*) &accumulator[i]);
+            __m128i w = _mm_loadu_si128((const __m128i*) &weights[i]);
+            _mm_storeu_si128((__m128i*) &accumulator[i], _mm_add_epi16(a, w));
+        }
+    }
+
+    void remove_feature(const Network& network, int16_t* accumulator, int feature) {
+        const int16_t* weights = &network.feature_weights[feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*) &accumulator[i]);
+            __m128i w = _mm_loadu_si128((const __m128i*) &weights[i]);
+            _mm_storeu_si128((__m128i*) &accumulator[i], _mm_sub_epi16(a, w));
+        }
+    }
+
+    void move_feature(const Network& network, int16_t* accumulator, int from_feature, int to_feature) {
+        const int16_t* from_weights = &network.feature_weights[from_feature * NNUE_HIDDEN];
+        const int16_t* to_weights = &network.feature_weights[to_feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*) &accumulator[i]);
+            a = _mm_sub_epi16(a, _mm_loadu_si128((const __m128i*) &from_weights[i]));
+            a = _mm_add_epi16(a, _mm_loadu_si128((const __m128i*) &to_weights[i]));
+            _mm_storeu_si128((__m128i*) &accumulator[i], a);
+        }
+    }
+
+    // sum of clamp(accumulator, 0, QA) * weights
+    static int32_t clipped_dot(const int16_t* accumulator, const int16_t* weights) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i qa = _mm_set1_epi16(QA);
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*) &accumulator[i]);
+            a = _mm_min_epi16(_mm_max_epi16(a, zero), qa);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(a, _mm_loadu_si128((const __m128i*) &weights[i])));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum);
+    }
+
+    const char* simd() { return "SSE4.1"; }
+
+#else
+
+    // int16 arithmetic wraps around like the vector instructions do, so the accumulators match theirs exactly
+    void add_feature(const Network& network, int16_t* accumulator, int feature) {
+        const int16_t* weights = &network.feature_weights[feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            accumulator[i] = (int16_t) (accumulator[i] + weights[i]);
+        }
+    }
+
+    void remove_feature(const Network& network, int16_t* accumulator, int feature) {
+        const int16_t* weights = &network.feature_weights[feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            accumulator[i] = (int16_t) (accumulator[i] - weights[i]);
+        }
+    }
+
+    void move_feature(const Network& network, int16_t* accumulator, int from_feature, int to_feature) {
+        const int16_t* from_weights = &network.feature_weights[from_feature * NNUE_HIDDEN];
+        const int16_t* to_weights = &network.feature_weights[to_feature * NNUE_HIDDEN];
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            accumulator[i] = (int16_t) (accumulator[i] - from_weights[i] + to_weights[i]);
+        }
+    }
+
+    // sum of clamp(accumulator, 0, QA) * weights
+    static int32_t clipped_dot(const int16_t* accumulator, const int16_t* weights) {
+        int32_t sum = 0;
+        for (int i = 0; i < NNUE_HIDDEN; i++) {
+            int a = accumulator[i] < 0 ? 0 : accumulator[i] > QA ? QA : accumulator[i];
+            sum += a * weights[i];
+        }
+        return sum;
+    }
+
+    const char* simd() { return "scalar"; }
+
+#endif
+
+    int evaluate(const Network& network, const int16_t* us, const int16_t* them) {
+        int64_t output = (int64_t) clipped_dot(us, network.output_weights) + clipped_dot(them, &network.output_weights[NNUE_HIDDEN])
+            + network.output_bias;
+        int centipawns = (int) (output * SCALE / (QA * QB));
+        return centipawns * Evaluation::piece_values[PAWN_INDEX] / 100;
+    }
+}
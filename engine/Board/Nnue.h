@@ -0,0 +1,70 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "Bitboard.h"
+#include <string>
+using std::string;
+
+// One input per color (relative to the perspective), piece index and square
+#define NNUE_INPUTS (NUM_COLORS * NUM_PIECE_TYPES * NUM_SQUARES)
+// Neurons of the first layer, for each perspective. Must be a multiple of 16 (the int16 lanes of an AVX2 register)
+#define NNUE_HIDDEN 256
+
+/*
+ * Efficiently updatable neural network evaluation (https://www.chessprogramming.org/NNUE), which can replace the hand-written evaluation
+ * of ChessEngine (see ChessEngine::load_network)
+ *
+ * The network is (768 -> NNUE_HIDDEN) x 2 -> 1. Inputs are the pieces on the board as seen from one side (WHITE or BLACK, the perspective):
+ * whether the piece is the perspective's own or the opponent's, its piece index, and its square, flipped vertically for BLACK. The first layer
+ * for each perspective (its accumulator) is the sum of the weights of the inputs that are set, which changes by only a few inputs per move,
+ * so Position adds and subtracts them as pieces move instead of computing it again (see Position::set_network)
+ * The accumulators of the side to move and of the opponent are clipped to [0, QA] and joined by the output layer into the score
+ *
+ * Weights are quantized to int16: the first layer by QA, the output layer by QB. Kernels use AVX2 or SSE4.1 when the compiler targets them
+ * (e.g. -mavx2, or -march=native) and plain C++ otherwise, and give the same results
+*/
+namespace Nnue {
+    const int QA = 255;
+    const int QB = 64;
+    // the network's output is in centipawns once multiplied by SCALE and divided by QA * QB
+    const int SCALE = 400;
+
+    struct Network {
+        // NNUE_HIDDEN weights for each input, one input after another
+        int16_t feature_weights[NNUE_INPUTS * NNUE_HIDDEN];
+        int16_t feature_biases[NNUE_HIDDEN];
+        // weights of the side to move's accumulator, then of the opponent's
+        int16_t output_weights[2 * NNUE_HIDDEN];
+        // quantized by QA * QB
+        int32_t output_bias;
+    };
+
+    /*
+     * Loads a network from a file, or returns NULL if it cannot be read or is not a network of this size. The file holds the 4 bytes "CNUE",
+     * the number of inputs and of hidden neurons as 32-bit integers, then the fields of Network in order, all little endian
+    */
+    Network* load(const string& path);
+
+    // Returns the input of a piece (color index and piece index) on a square, as seen from the perspective color index
+    inline int feature(int perspective, int color, int type, int square) {
+        return ((color != perspective) * NUM_PIECE_TYPES + type) * NUM_SQUARES + (perspective == WHITE_INDEX ? square : square ^ 56);
+    }
+
+    // Sets an accumulator to the biases, as for an empty board
+    void reset(const Network& network, int16_t* accumulator);
+    // Adds or subtracts the weights of an input to or from an accumulator
+    void add_feature(const Network& network, int16_t* accumulator, int feature);
+    void remove_feature(const Network& network, int16_t* accumulator, int feature);
+    // Replaces one input with another, in a single pass over the accumulator
+    void move_feature(const Network& network, int16_t* accumulator, int from_feature, int to_feature);
+
+    /*
+     * Returns the score for the side to move on the evaluation scale (see Evaluation.h), given its accumulator (us) and the opponent's (them)
+    */
+    int evaluate(const Network& network, const int16_t* us, const int16_t* them);
+
+    // Name of the instruction set the kernels were built for: "AVX2", "SSE4.1" or "scalar"
+    const char* simd();
+}
+
+#endif
@@ -0,0 +1,393 @@
+#include "Position.h"
+#include <cctype>
+#include <cstring>
+
+// Castling rights that remain after a piece moves from or to the given square
+static int castling_mask(int square) {
+    switch (square) {
+        case 0: return ALL_CASTLING & ~WHITE_QUEENSIDE;
+        case 4: return ALL_CASTLING & ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+        case 7: return ALL_CASTLING & ~WHITE_KINGSIDE;
+        case 56: return ALL_CASTLING & ~BLACK_QUEENSIDE;
+        case 60: return ALL_CASTLING & ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+        case 63: return ALL_CASTLING & ~BLACK_KINGSIDE;
+        default: return ALL_CASTLING;
+    }
+}
+
+Position::Position() : network(NULL) {
+    Attacks::init_attacks();
+    Zobrist::init_zobrist();
+    Evaluation::init_evaluation();
+    memset(accumulators, 0, sizeof(accumulators));
+    clear();
+    const PieceType back_rank[8] = { ROOK, KNIGHT, BISHOP, QUEEN, KING, BISHOP, KNIGHT, ROOK };
+    for (int x = 0; x < 8; x++) {
+        set_piece(make_square(x, 0), WHITE, back_rank[x]);
+        set_piece(make_square(x, 1), WHITE, PAWN);
+        set_piece(make_square(x, 6), BLACK, PAWN);
+        set_piece(make_square(x, 7), BLACK, back_rank[x]);
+    }
+    set_castling_rights(ALL_CASTLING);
+}
+
+void Position::clear() {
+    for (int c = 0; c < NUM_COLORS; c++) {
+        for (int t = 0; t < NUM_PIECE_TYPES; t++) {
+            pieces[c][t] = EMPTY_BB;
+        }
+        occupancy[c] = EMPTY_BB;
+        for (int phase = 0; phase < Evaluation::NUM_PHASES; phase++) {
+            scores[phase][c] = 0;
+        }
+    }
+    occupied = EMPTY_BB;
+    phase = 0;
+    for (int s = 0; s < NUM_SQUARES; s++) {
+        squares[s] = NO_PIECE;
+    }
+    side = WHITE;
+    castling_rights = 0;
+    en_passant_square = NO_SQUARE;
+    key = 0;
+    pawn_key = 0;
+    if (network != NULL) {
+        for (int perspective = 0; perspective < NUM_COLORS; perspective++) {
+            Nnue::reset(*network, accumulators[perspective]);
+        }
+    }
+    history.clear();
+}
+
+bool Position::set_fen(const string& fen) {
+    clear();
+    const string piece_chars = "PNBRQK";
+    unsigned i = 0;
+    int x = 0, y = 7;
+    // piece placement, from a8 to h1
+    for (; i < fen.length() && fen[i] != ' '; i++) {
+        char c = fen[i];
+        if (c == '/') {
+            x = 0;
+            y--;
+        } else if (c >= '1' && c <= '8') {
+            x += c - '0';
+        } else {
+            size_t type = piece_chars.find(toupper(c));
+            if (type == string::npos || x > 7 || y < 0) {
+                clear();
+                return false;
+            }
+            put_piece(make_square(x, y), make_piece(isupper(c) ? WHITE_INDEX : BLACK_INDEX, type));
+            x++;
+        }
+    }
+    // side to move
+    while (i < fen.length() && fen[i] == ' ') i++;
+    if (i < fen.length()) side = fen[i++] == 'b' ? BLACK : WHITE;
+    // castling rights
+    while (i < fen.length() && fen[i] == ' ') i++;
+    for (; i < fen.length() && fen[i] != ' '; i++) {
+        switch (fen[i]) {
+            case 'K': castling_rights |= WHITE_KINGSIDE; break;
+            case 'Q': castling_rights |= WHITE_QUEENSIDE; break;
+            case 'k': castling_rights |= BLACK_KINGSIDE; break;
+            case 'q': castling_rights |= BLACK_QUEENSIDE; break;
+            default: break;
+        }
+    }
+    // en passant square, only kept if a pawn of the side to move can capture the enemy pawn that just passed it, since an en passant move
+    // removes that pawn without checking it is there
+    while (i < fen.length() && fen[i] == ' ') i++;
+    if (i + 1 < fen.length() && fen[i] >= 'a' && fen[i] <= 'h' && fen[i + 1] >= '1' && fen[i + 1] <= '8') {
+        int square = make_square(fen[i] - 'a', fen[i + 1] - '1');
+        int us = color_index(side), them = us ^ 1;
+        int passed = make_square(square_x(square), us == WHITE_INDEX ? 4 : 3);
+        if (square_y(square) == (us == WHITE_INDEX ? 5 : 2) && squares[square] == NO_PIECE && squares[passed] == make_piece(them, PAWN_INDEX)
+            && (pawn_attacks(them, square) & pieces[us][PAWN_INDEX])) {
+            en_passant_square = square;
+        }
+    }
+    key = compute_key();
+    return true;
+}
+
+void Position::put_piece(int square, int piece) {
+    Bitboard b = square_bb(square);
+    pieces[piece_color(piece)][piece_type(piece)] |= b;
+    occupancy[piece_color(piece)] |= b;
+    occupied |= b;
+    squares[square] = piece;
+    key ^= Zobrist::piece_keys[piece_color(piece)][piece_type(piece)][square];
+    if (piece_type(piece) == PAWN_INDEX) pawn_key ^= Zobrist::piece_keys[piece_color(piece)][PAWN_INDEX][square];
+    phase += Evaluation::phase_weights[piece_type(piece)];
+    for (int phase = 0; phase < Evaluation::NUM_PHASES; phase++) {
+        scores[phase][piece_color(piece)] += Evaluation::piece_square[phase][piece_color(piece)][piece_type(piece)][square];
+    }
+    if (network != NULL) {
+        for (int perspective = 0; perspective < NUM_COLORS; perspective++) {
+            int feature = Nnue::feature(perspective, piece_color(piece), piece_type(piece), square);
+            Nnue::add_feature(*network, accumulators[perspective], feature);
+        }
+    }
+}
+
+void Position::remove_piece(int square) {
+    int piece = squares[square];
+    Bitboard b = square_bb(square);
+    pieces[piece_color(piece)][piece_type(piece)] &= ~b;
+    occupancy[piece_color(piece)] &= ~b;
+    occupied &= ~b;
+    squares[square] = NO_PIECE;
+    key ^= Zobrist::piece_keys[piece_color(piece)][piece_type(piece)][square];
+    if (piece_type(piece) == PAWN_INDEX) pawn_key ^= Zobrist::piece_keys[piece_color(piece)][PAWN_INDEX][square];
+    phase -= Evaluation::phase_weights[piece_type(piece)];
+    for (int phase = 0; phase < Evaluation::NUM_PHASES; phase++) {
+        scores[phase][piece_color(piece)] -= Evaluation::piece_square[phase][piece_color(piece)][piece_type(piece)][square];
+    }
+    if (network != NULL) {
+        for (int perspective = 0; perspective < NUM_COLORS; perspective++) {
+            int feature = Nnue::feature(perspective, piece_color(piece), piece_type(piece), square);
+            Nnue::remove_feature(*network, accumulators[perspective], feature);
+        }
+    }
+}
+
+void Position::move_piece(int from, int to) {
+    int piece = squares[from];
+    Bitboard from_to = square_bb(from) | square_bb(to);
+    pieces[piece_color(piece)][piece_type(piece)] ^= from_to;
+    occupancy[piece_color(piece)] ^= from_to;
+    occupied ^= from_to;
+    squares[from] = NO_PIECE;
+    squares[to] = piece;
+    key ^= Zobrist::piece_keys[piece_color(piece)][piece_type(piece)][from] ^ Zobrist::piece_keys[piece_color(piece)][piece_type(piece)][to];
+    if (piece_type(piece) == PAWN_INDEX) {
+        pawn_key ^= Zobrist::piece_keys[piece_color(piece)][PAWN_INDEX][from] ^ Zobrist::piece_keys[piece_color(piece)][PAWN_INDEX][to];
+    }
+    for (int phase = 0; phase < Evaluation::NUM_PHASES; phase++) {
+        const int* table = Evaluation::piece_square[phase][piece_color(piece)][piece_type(piece)];
+        scores[phase][piece_color(piece)] += table[to] - table[from];
+    }
+    if (network != NULL) {
+        for (int perspective = 0; perspective < NUM_COLORS; perspective++) {
+            Nnue::move_feature(*network, accumulators[perspective], Nnue::feature(perspective, piece_color(piece), piece_type(piece), from),
+                Nnue::feature(perspective, piece_color(piece), piece_type(piece), to));
+        }
+    }
+}
+
+void Position::set_network(const Nnue::Network* new_network) {
+    network = new_network;
+    if (network == NULL) return;
+    for (int perspective = 0; perspective < NUM_COLORS; perspective++) {
+        compute_accumulator(perspective, accumulators[perspective]);
+    }
+}
+
+void Position::set_side(Color color) {
+    if (color != side) key ^= Zobrist::side_key;
+    side = color;
+}
+
+void Position::set_castling_rights(int rights) {
+    key ^= Zobrist::castling_keys[castling_rights] ^ Zobrist::castling_keys[rights];
+    castling_rights = rights;
+}
+
+void Position::set_en_passant_square(int square) {
+    if (en_passant_square != NO_SQUARE) key ^= Zobrist::en_passant_keys[square_x(en_passant_square)];
+    en_passant_square = square;
+    if (en_passant_square != NO_SQUARE) key ^= Zobrist::en_passant_keys[square_x(en_passant_square)];
+}
+
+void Position::set_piece(int square, Color color, PieceType type) {
+    if (squares[square] != NO_PIECE) remove_piece(square);
+    put_piece(square, make_piece(color_index(color), piece_index(type)));
+}
+
+void Position::clear_square(int square) {
+    if (squares[square] != NO_PIECE) remove_piece(square);
+}
+
+Bitboard Position::attackers_to(int square, Bitboard blockers) const {
+    Bitboard bishops = pieces[WHITE_INDEX][BISHOP_INDEX] | pieces[BLACK_INDEX][BISHOP_INDEX]
+        | pieces[WHITE_INDEX][QUEEN_INDEX] | pieces[BLACK_INDEX][QUEEN_INDEX];
+    Bitboard rooks = pieces[WHITE_INDEX][ROOK_INDEX] | pieces[BLACK_INDEX][ROOK_INDEX]
+        | pieces[WHITE_INDEX][QUEEN_INDEX] | pieces[BLACK_INDEX][QUEEN_INDEX];
+    return (pawn_attacks(BLACK_INDEX, square) & pieces[WHITE_INDEX][PAWN_INDEX])
+        | (pawn_attacks(WHITE_INDEX, square) & pieces[BLACK_INDEX][PAWN_INDEX])
+        | (knight_attacks(square) & (pieces[WHITE_INDEX][KNIGHT_INDEX] | pieces[BLACK_INDEX][KNIGHT_INDEX]))
+        | (king_attacks(square) & (pieces[WHITE_INDEX][KING_INDEX] | pieces[BLACK_INDEX][KING_INDEX]))
+        | (bishop_attacks(square, blockers) & bishops)
+        | (rook_attacks(square, blockers) & rooks);
+}
+
+bool Position::is_attacked(int square, int by_color, Bitboard blockers) const {
+    // a pawn of by_color attacks square if a pawn of the other color on square would attack it
+    if (pawn_attacks(by_color ^ 1, square) & pieces[by_color][PAWN_INDEX]) return true;
+    if (knight_attacks(square) & pieces[by_color][KNIGHT_INDEX]) return true;
+    if (king_attacks(square) & pieces[by_color][KING_INDEX]) return true;
+    Bitboard queens = pieces[by_color][QUEEN_INDEX];
+    if (bishop_attacks(square, blockers) & (pieces[by_color][BISHOP_INDEX] | queens)) return true;
+    return rook_attacks(square, blockers) & (pieces[by_color][ROOK_INDEX] | queens);
+}
+
+bool Position::in_check(int color) const {
+    int king = king_square(color);
+    return king != NO_SQUARE && is_attacked(king, color ^ 1);
+}
+
+int Position::see(BoardMove m) const {
+    int from = m.from(), to = m.to(), flag = m.flag();
+    if (flag == CASTLE_MOVE) return 0;
+    // gain[d] is what the side making the d-th capture wins, if the exchange stopped right after it
+    int gain[32];
+    int d = 0;
+    Bitboard occupancy_left = occupied ^ square_bb(from);
+    if (flag == EN_PASSANT_MOVE) {
+        occupancy_left ^= square_bb(make_square(square_x(to), square_y(from)));
+        gain[0] = Evaluation::piece_values[PAWN_INDEX];
+    } else {
+        gain[0] = squares[to] == NO_PIECE ? 0 : Evaluation::piece_values[piece_type(squares[to])];
+    }
+    // value of the piece standing on the square, which the next capture takes
+    int on_square = Evaluation::piece_values[piece_type(squares[from])];
+    if (flag == PROMOTION_MOVE) {
+        int promoted = piece_index(m.promote_to() == NONE ? QUEEN : m.promote_to());
+        gain[0] += Evaluation::piece_values[promoted] - Evaluation::piece_values[PAWN_INDEX];
+        on_square = Evaluation::piece_values[promoted];
+    }
+    Bitboard bishops = pieces[WHITE_INDEX][BISHOP_INDEX] | pieces[BLACK_INDEX][BISHOP_INDEX]
+        | pieces[WHITE_INDEX][QUEEN_INDEX] | pieces[BLACK_INDEX][QUEEN_INDEX];
+    Bitboard rooks = pieces[WHITE_INDEX][ROOK_INDEX] | pieces[BLACK_INDEX][ROOK_INDEX]
+        | pieces[WHITE_INDEX][QUEEN_INDEX] | pieces[BLACK_INDEX][QUEEN_INDEX];
+    Bitboard attackers = attackers_to(to, occupancy_left) & occupancy_left;
+    int color = piece_color(squares[from]) ^ 1;
+    while (d < 31) {
+        Bitboard own = attackers & occupancy[color];
+        if (!own) break;
+        int type = PAWN_INDEX;
+        while (!(own & pieces[color][type])) type++;
+        // the king can only take last, when nothing defends the square anymore
+        if (type == KING_INDEX && (attackers & occupancy[color ^ 1])) break;
+        d++;
+        gain[d] = on_square - gain[d - 1];
+        on_square = Evaluation::piece_values[type];
+        Bitboard attacker = own & pieces[color][type];
+        occupancy_left ^= attacker & (0 - attacker);
+        // sliders lined up behind the piece that just captured now reach the square
+        attackers |= (bishop_attacks(to, occupancy_left) & bishops) | (rook_attacks(to, occupancy_left) & rooks);
+        attackers &= occupancy_left;
+        color ^= 1;
+    }
+    // each side only takes if it is better than stopping, from the last capture back to the first
+    for (; d > 0; d--) {
+        gain[d - 1] = -(-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]);
+    }
+    return gain[0];
+}
+
+void Position::make_move(BoardMove m) {
+    int from = m.from(), to = m.to(), flag = m.flag();
+    UndoInfo undo;
+    undo.move = m;
+    undo.captured = squares[to];
+    undo.castling_rights = castling_rights;
+    undo.en_passant_square = en_passant_square;
+    undo.side = side;
+    undo.key = key;
+    history.push_back(undo);
+
+    set_en_passant_square(NO_SQUARE);
+    if (undo.captured != NO_PIECE) remove_piece(to);
+    move_piece(from, to);
+    if (piece_type(squares[to]) == PAWN_INDEX && (to - from == 16 || from - to == 16)) {
+        set_en_passant_square((from + to) / 2);
+    }
+    if (flag == EN_PASSANT_MOVE) {
+        // the captured pawn is next to the moving pawn, on the square it started from
+        remove_piece(make_square(square_x(to), square_y(from)));
+    } else if (flag == CASTLE_MOVE) {
+        int row = square_y(from);
+        if (square_x(to) == 6) move_piece(make_square(7, row), make_square(5, row));
+        else move_piece(make_square(0, row), make_square(3, row));
+    } else if (flag == PROMOTION_MOVE && m.promote_to() != NONE) {
+        promote(to, m.promote_to());
+    }
+    set_castling_rights(castling_rights & castling_mask(from) & castling_mask(to));
+    set_side(get_other_color(side));
+}
+
+void Position::unmake_move() {
+    if (history.empty()) return;
+    UndoInfo undo = history.back();
+    history.pop_back();
+    BoardMove m = undo.move;
+    int from = m.from(), to = m.to(), flag = m.flag();
+
+    int mover = piece_color(squares[to]);
+    if (flag == PROMOTION_MOVE) {
+        // whatever the pawn was promoted to (if anything), it goes back to being a pawn
+        remove_piece(to);
+        put_piece(from, make_piece(mover, PAWN_INDEX));
+    } else {
+        move_piece(to, from);
+        if (flag == CASTLE_MOVE) {
+            int row = square_y(from);
+            if (square_x(to) == 6) move_piece(make_square(5, row), make_square(7, row));
+            else move_piece(make_square(3, row), make_square(0, row));
+        } else if (flag == EN_PASSANT_MOVE) {
+            put_piece(make_square(square_x(to), square_y(from)), make_piece(mover ^ 1, PAWN_INDEX));
+        }
+    }
+    if (undo.captured != NO_PIECE) put_piece(to, undo.captured);
+    castling_rights = undo.castling_rights;
+    en_passant_square = undo.en_passant_square;
+    side = undo.side;
+    // the saved key covers everything restored above
+    key = undo.key;
+}
+
+void Position::promote(int square, PieceType type) {
+    int piece = squares[square];
+    if (piece == NO_PIECE || piece_type(piece) != PAWN_INDEX) return;
+    remove_piece(square);
+    put_piece(square, make_piece(piece_color(piece), piece_index(type)));
+}
+
+uint64_t Position::compute_key() const {
+    uint64_t key = 0;
+    Bitboard b = occupied;
+    while (b) {
+        int square = pop_lsb(b);
+        int piece = squares[square];
+        key ^= Zobrist::piece_keys[piece_color(piece)][piece_type(piece)][square];
+    }
+    if (side == BLACK) key ^= Zobrist::side_key;
+    key ^= Zobrist::castling_keys[castling_rights];
+    if (en_passant_square != NO_SQUARE) key ^= Zobrist::en_passant_keys[square_x(en_passant_square)];
+    return key;
+}
+
+uint64_t Position::compute_pawn_key() const {
+    uint64_t key = 0;
+    for (int color = 0; color < NUM_COLORS; color++) {
+        Bitboard pawns = pieces[color][PAWN_INDEX];
+        while (pawns) {
+            key ^= Zobrist::piece_keys[color][PAWN_INDEX][pop_lsb(pawns)];
+        }
+    }
+    return key;
+}
+
+void Position::compute_accumulator(int perspective, int16_t accumulator[NNUE_HIDDEN]) const {
+    if (network == NULL) return;
+    Nnue::reset(*network, accumulator);
+    Bitboard b = occupied;
+    while (b) {
+        int square = pop_lsb(b);
+        int piece = squares[square];
+        Nnue::add_feature(*network, accumulator, Nnue::feature(perspective, piece_color(piece), piece_type(piece), square));
+    }
+}
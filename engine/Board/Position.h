@@ -0,0 +1,245 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "Bitboard.h"
+#include "Attacks.h"
+#include "Zobrist.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "../Util/FixedStack.h"
+#include <vector>
+#include <string>
+using std::vector;
+using std::string;
+
+#define NO_PIECE -1
+// Most moves a game can be played to (see ChessGame::move_piece)
+#define MAX_GAME_MOVES 1024
+// Moves the undo stacks hold: a game of MAX_GAME_MOVES, plus the line a search plays out on top of it (at most MAX_SEARCH_PLY, see Engine.h)
+#define HISTORY_CAPACITY (MAX_GAME_MOVES + 128)
+
+/*
+ * Castling rights, stored as a bitmask inside Position
+*/
+enum CastlingRight {
+    WHITE_KINGSIDE = 1,
+    WHITE_QUEENSIDE = 2,
+    BLACK_KINGSIDE = 4,
+    BLACK_QUEENSIDE = 8,
+    ALL_CASTLING = 15
+};
+
+/*
+ * Special move flags for BoardMove
+*/
+enum BoardMoveFlag {
+    NORMAL_MOVE = 0,
+    CASTLE_MOVE = 1,
+    PROMOTION_MOVE = 2,
+    EN_PASSANT_MOVE = 3
+};
+
+/*
+ * Move used by Position and the engine's search, packed into 16 bits. Squares are 0-63 (see Bitboard.h)
+ * Bits 0-5 hold the from square, bits 6-11 the to square, and bits 12-15 the kind of move: the BoardMoveFlag, or for a promotion
+ * with its piece chosen, 4 plus the index of the piece in promote_to_pieces
+ * For promotions, promote_to is NONE while the promotion is still pending (the pawn stays on the last rank until Position::promote is called)
+ * The packed bits are what the transposition table, killer moves and principal variations store. 0 (a1 to a1) is never a legal move
+*/
+class BoardMove {
+private:
+    uint16_t data;
+
+    static int promotion_kind(PieceType promote_to) {
+        switch (promote_to) {
+            case KNIGHT: return 4;
+            case BISHOP: return 5;
+            case ROOK: return 6;
+            case QUEEN: return 7;
+            default: return PROMOTION_MOVE;
+        }
+    }
+
+public:
+    BoardMove() : data(0) {}
+    BoardMove(int from, int to, int flag = NORMAL_MOVE, PieceType promote_to = NONE)
+        : data(from | to << 6 | (flag == PROMOTION_MOVE ? promotion_kind(promote_to) : flag) << 12) {}
+
+    // Unpacks a move from its packed bits
+    static BoardMove from_bits(uint16_t bits) {
+        BoardMove m;
+        m.data = bits;
+        return m;
+    }
+    uint16_t bits() const { return data; }
+
+    int from() const { return data & 63; }
+    int to() const { return (data >> 6) & 63; }
+    int flag() const { return data >> 12 >= 4 ? PROMOTION_MOVE : data >> 12; }
+    PieceType promote_to() const { return data >> 12 >= 4 ? promote_to_pieces[(data >> 12) - 4] : NONE; }
+    // Chooses the piece of a promotion
+    void set_promote_to(PieceType promote_to) { data = (data & 4095) | promotion_kind(promote_to) << 12; }
+
+    bool operator==(const BoardMove& other) const { return data == other.data; }
+    bool operator!=(const BoardMove& other) const { return data != other.data; }
+};
+
+/*
+ * Bitboard representation of a chess position
+ * Keeps one bitboard per color and piece type, occupancy bitboards, and a square lookup table so that the piece on a square can be
+ * found in O(1). Moves are made and unmade in place, with the information required to undo a move kept on an internal stack
+ *
+ * Initializes as the standard starting position with WHITE to move
+*/
+class Position {
+private:
+    // piece codes stored in squares are color_index * NUM_PIECE_TYPES + piece_index, or NO_PIECE
+    Bitboard pieces[NUM_COLORS][NUM_PIECE_TYPES];
+    Bitboard occupancy[NUM_COLORS];
+    Bitboard occupied;
+    signed char squares[NUM_SQUARES];
+    Color side;
+    int castling_rights;
+    // square a pawn skipped over with its last move (capturable en passant), or NO_SQUARE
+    int en_passant_square;
+    // Zobrist key, updated incrementally along with the rest of the state
+    uint64_t key;
+    // Zobrist key of the pawns only
+    uint64_t pawn_key;
+    // sum of Evaluation::piece_square over the pieces of each color, for each game phase
+    int scores[Evaluation::NUM_PHASES][NUM_COLORS];
+    // game phase, see Evaluation.h
+    int phase;
+    // network whose accumulators (one per perspective color index, see Nnue.h) are kept up to date along with the scores, or NULL
+    const Nnue::Network* network;
+    int16_t accumulators[NUM_COLORS][NNUE_HIDDEN];
+
+    // information needed to undo a move, pushed on make_move and popped on unmake_move. Plain data, kept in a fixed capacity stack
+    struct UndoInfo {
+        BoardMove move;
+        int captured;
+        int castling_rights;
+        int en_passant_square;
+        // side to move before the move, which the saved key was computed with. Not always the mover: ChessGame keeps the side of its turn
+        Color side;
+        uint64_t key;
+    };
+    FixedStack<UndoInfo, HISTORY_CAPACITY> history;
+
+    void put_piece(int square, int piece);
+    void remove_piece(int square);
+    void move_piece(int from, int to);
+
+public:
+    Position();
+
+    // Removes every piece and castling right from the position
+    void clear();
+
+    /*
+     * Sets up the position from a FEN string (https://www.chessprogramming.org/Forsyth-Edwards_Notation)
+     * Move counters are ignored. Returns false (leaving the position cleared) if the FEN cannot be parsed
+    */
+    bool set_fen(const string& fen);
+
+    static int make_piece(int color, int type) { return color * NUM_PIECE_TYPES + type; }
+    static int piece_color(int piece) { return piece / NUM_PIECE_TYPES; }
+    static int piece_type(int piece) { return piece % NUM_PIECE_TYPES; }
+
+    Bitboard get_pieces(int color, int type) const { return pieces[color][type]; }
+    Bitboard get_occupancy(int color) const { return occupancy[color]; }
+    Bitboard get_occupied() const { return occupied; }
+    // Returns piece code at square, or NO_PIECE
+    int piece_on(int square) const { return squares[square]; }
+    bool is_empty(int square) const { return squares[square] == NO_PIECE; }
+    // Returns the king square for the color index, or NO_SQUARE if that color has no king
+    int king_square(int color) const { return pieces[color][KING_INDEX] ? lsb(pieces[color][KING_INDEX]) : NO_SQUARE; }
+
+    Color get_side() const { return side; }
+    void set_side(Color color);
+    int get_castling_rights() const { return castling_rights; }
+    void set_castling_rights(int rights);
+    int get_en_passant_square() const { return en_passant_square; }
+    void set_en_passant_square(int square);
+
+    /*
+     * Returns the Zobrist key of the position, covering piece placement, side to move, castling rights and en passant file
+     * A pawn waiting for promotion is keyed as a pawn on the last rank, so pending and completed promotions have different keys
+    */
+    uint64_t get_key() const { return key; }
+    /*
+     * Returns the Zobrist key of the pawns alone (the XOR of their piece keys), for caching pawn structure evaluation
+     * Changes far less often than the position key, since most moves do not move or capture a pawn
+    */
+    uint64_t get_pawn_key() const { return pawn_key; }
+
+    /*
+     * Returns the material and piece-square score of the pieces of a color index in the given game phase (see Evaluation.h)
+     * Kept up to date on every change to the position, so reading it is O(1)
+    */
+    int get_score(int phase, int color) const { return scores[phase][color]; }
+    // Returns the game phase of the position (see Evaluation.h), kept up to date like the scores
+    int get_phase() const { return phase; }
+
+    /*
+     * Sets the network whose accumulators the position keeps up to date, computing them from scratch, or stops updating them (NULL, the default)
+     * Pieces then add and subtract their weights as they are placed, moved and removed, including when moves are unmade, so reading the
+     * accumulators is O(1). Copies of the position share the network, which has to outlive them or be unset first
+    */
+    void set_network(const Nnue::Network* new_network);
+    const Nnue::Network* get_network() const { return network; }
+    // Returns the accumulator of the perspective color index. Only meaningful while a network is set
+    const int16_t* get_accumulator(int perspective) const { return accumulators[perspective]; }
+
+    /*
+     * Places (or removes) a piece directly, without recording anything in the move history
+     * Used for setting up positions
+    */
+    void set_piece(int square, Color color, PieceType type);
+    void clear_square(int square);
+
+    /*
+     * Returns all pieces of both colors attacking the square, given the blocking pieces
+    */
+    Bitboard attackers_to(int square, Bitboard blockers) const;
+    // Checks if square is attacked by any piece of the given color index. Slider attacks can be computed with a different set of blockers
+    bool is_attacked(int square, int by_color) const { return is_attacked(square, by_color, occupied); }
+    bool is_attacked(int square, int by_color, Bitboard blockers) const;
+    // Checks if the given color index is in check
+    bool in_check(int color) const;
+    /*
+     * Static exchange evaluation (https://www.chessprogramming.org/Static_Exchange_Evaluation): the material the side making the move wins
+     * (or loses, if negative) on its destination square, on the evaluation scale, if both sides keep recapturing there with their least valuable
+     * attacker for as long as it pays off. Sliders behind the pieces that capture join in as the exchange uncovers them (x-rays)
+     * Pins and checks are ignored. A pending promotion is counted as a queen promotion
+    */
+    int see(BoardMove m) const;
+
+    /*
+     * Performs a move. The move is assumed to be at least pseudo-legal
+     * Flips the side to move. Aborts the program if the undo stack already holds HISTORY_CAPACITY moves
+    */
+    void make_move(BoardMove m);
+    /*
+     * Undoes the last move made with make_move
+    */
+    void unmake_move();
+    /*
+     * Replaces a pawn waiting for promotion on square with the given piece type
+    */
+    void promote(int square, PieceType type);
+
+    /*
+     * Computes the Zobrist key of the position from scratch (see Zobrist.h). Should always equal get_key()
+    */
+    uint64_t compute_key() const;
+    // Computes the pawn key from scratch. Should always equal get_pawn_key()
+    uint64_t compute_pawn_key() const;
+    // Computes the accumulator of the perspective color index from scratch. Should always equal get_accumulator(perspective)
+    void compute_accumulator(int perspective, int16_t accumulator[NNUE_HIDDEN]) const;
+
+    // Number of moves currently on the undo stack, at most HISTORY_CAPACITY
+    int history_size() const { return history.size(); }
+};
+
+#endif
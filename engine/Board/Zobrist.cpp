@@ -0,0 +1,48 @@
+#include "Zobrist.h"
+
+namespace Zobrist {
+    uint64_t piece_keys[NUM_COLORS][NUM_PIECE_TYPES][NUM_SQUARES];
+    uint64_t side_key;
+    uint64_t castling_keys[16];
+    uint64_t en_passant_keys[8];
+
+    // splitmix64, so keys are the same on every run
+    static uint64_t next_key(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static bool build_keys() {
+        uint64_t state = 1070372;
+        for (int c = 0; c < NUM_COLORS; c++) {
+            for (int t = 0; t < NUM_PIECE_TYPES; t++) {
+                for (int s = 0; s < NUM_SQUARES; s++) {
+                    piece_keys[c][t][s] = next_key(state);
+                }
+            }
+        }
+        side_key = next_key(state);
+        // each castling right gets its own key, and a set of rights is the XOR of its members
+        uint64_t right_keys[4];
+        for (int i = 0; i < 4; i++) {
+            right_keys[i] = next_key(state);
+        }
+        for (int rights = 0; rights < 16; rights++) {
+            castling_keys[rights] = 0;
+            for (int i = 0; i < 4; i++) {
+                if (rights & (1 << i)) castling_keys[rights] ^= right_keys[i];
+            }
+        }
+        for (int x = 0; x < 8; x++) {
+            en_passant_keys[x] = next_key(state);
+        }
+        return true;
+    }
+
+    void init_zobrist() {
+        static bool initialized = build_keys();
+        (void) initialized;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "Bitboard.h"
+
+/*
+ * Random keys for Zobrist hashing (https://www.chessprogramming.org/Zobrist_Hashing)
+ * A position key is the XOR of the keys for every piece on its square, the side to move, the castling rights and the en passant file
+ * Keys are generated once per process from a fixed seed (see init_zobrist), so the same position always has the same key
+*/
+namespace Zobrist {
+    extern uint64_t piece_keys[NUM_COLORS][NUM_PIECE_TYPES][NUM_SQUARES];
+    // XORed in when BLACK is to move
+    extern uint64_t side_key;
+    // indexed by the castling rights bitmask
+    extern uint64_t castling_keys[16];
+    // indexed by the file of the en passant square
+    extern uint64_t en_passant_keys[8];
+
+    /*
+     * Generates all keys. Safe to call multiple times (and from multiple threads); only the first call does any work
+    */
+    void init_zobrist();
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "Game.h"
 #include "Engine.h"
+#include <cstring>
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#endif
 
 #pragma region CHESS_ENGINE_PRIVATE
 
@@ -8,190 +12,803 @@ int ChessEngine::random_number(int n1, int n2) {
     return uni(rng);
 }
 
-ChessEngine::PossibleMove* ChessEngine::create_possible_move(
-    Color color, Move root, Move move, int depth, int score, int best_score, PossibleMove *parent) {
-    struct PossibleMove pm;
-    pm.color = color; pm.root = root; pm.move = move; pm.depth = depth;
-    pm.score = score; pm.best_score = best_score; pm.parent = parent;
-    PossibleMove* pma = new PossibleMove(pm);
-    return pma;
+uint64_t ChessEngine::position_key(Color color, ChessGame* game) {
+    uint64_t key = game->get_key();
+    if (game->get_turn() != color) key ^= Zobrist::side_key;
+    return key;
 }
 
-#pragma endregion CHESS_ENGINE_PRIVATE
-
-#pragma region CHESS_ENGINE_PUBLIC
+int ChessEngine::score_to_tt(int score, int ply) {
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
 
-ChessEngine::ChessEngine() : level(0), rng(mt19937(rd())) {}
-ChessEngine::ChessEngine(int level) : level(level), rng(mt19937(rd())) {}
+int ChessEngine::score_from_tt(int score, int ply) {
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
 
-Move ChessEngine::generate_random_move(Color color, ChessGame* game) {
-    vector<Move> possible_moves = game->get_all_valid_moves(color);
-    moves_considered = possible_moves.size();
-    Move move = possible_moves.at(random_number(0, possible_moves.size()));
-    if (move.type == PAWN_PROMOTION) {
-        move.promote_to = promote_to_pieces[random_number(0, 4)];
+int ChessEngine::evaluate(SearchThread& thread, Color color) {
+    const Position& position = thread.game->board->get_position();
+    // a network scores positions for the side to move, so the key includes it
+    uint64_t key = position_key(color, thread.game);
+    int score;
+    if (eval_cache.probe(key, score)) {
+        thread.eval_hits++;
+    } else {
+        thread.eval_misses++;
+        if (network != NULL) {
+            int us = color_index(color);
+            score = Nnue::evaluate(*network, position.get_accumulator(us), position.get_accumulator(us ^ 1));
+        } else {
+            score = evaluate(color, position, thread.pawns->probe(position));
+        }
+        eval_cache.store(key, score);
     }
-    return move;
+    return score;
 }
 
-Move ChessEngine::generate_move(Color color, ChessGame* game) {
-    if (level <= 0) return generate_random_move(color, game);
-    stack<PossibleMove*> pm_stack;
-    vector<PossibleMove> best_moves;
-    int best_score = INT32_MIN, worst_score = INT32_MAX;
-    int root_alpha = -INT16_MAX, root_beta = INT16_MAX;
-    Color other_color = get_other_color(color);
-    // first add all the first moves
-    vector<Move> first_moves = game->get_all_valid_moves(color);
-    int root_children_count = first_moves.size();
-    vector<PossibleMove*> first_pms;
-    for (auto m = first_moves.begin(); m != first_moves.end(); m++) {
-        if (m->type == PAWN_PROMOTION) {
+int ChessEngine::evaluate(Color color, const Position& position, const int pawn_scores[Evaluation::NUM_PHASES]) {
+    int us = color_index(color), them = us ^ 1;
+    int sign = us == WHITE_INDEX ? 1 : -1;
+    int piece_scores[Evaluation::NUM_PHASES];
+    Evaluation::evaluate_pieces(position, piece_scores);
+    int middlegame = position.get_score(Evaluation::MIDDLEGAME, us) - position.get_score(Evaluation::MIDDLEGAME, them)
+        + sign * (pawn_scores[Evaluation::MIDDLEGAME] + piece_scores[Evaluation::MIDDLEGAME]);
+    int endgame = position.get_score(Evaluation::ENDGAME, us) - position.get_score(Evaluation::ENDGAME, them)
+        + sign * (pawn_scores[Evaluation::ENDGAME] + piece_scores[Evaluation::ENDGAME]);
+    return Evaluation::taper(middlegame, endgame, position.get_phase());
+}
+
+int ChessEngine::captured_piece(const Position& position, const BoardMove& m) {
+    if (m.flag() == EN_PASSANT_MOVE) return PAWN_INDEX;
+    return position.is_empty(m.to()) ? NO_PIECE : Position::piece_type(position.piece_on(m.to()));
+}
+
+bool ChessEngine::is_quiet(const Position& position, const BoardMove& m) {
+    return m.flag() != PROMOTION_MOVE && captured_piece(position, m) == NO_PIECE;
+}
+
+bool ChessEngine::is_losing_capture(const Position& position, const BoardMove& m) {
+    int captured = captured_piece(position, m);
+    if (captured == NO_PIECE) return false;
+    // taking a piece worth at least the capturing one cannot lose material, whatever follows
+    int attacker = Position::piece_type(position.piece_on(m.from()));
+    if (m.flag() != PROMOTION_MOVE && Evaluation::piece_values[captured] >= Evaluation::piece_values[attacker]) return false;
+    return position.see(m) < 0;
+}
+
+void ChessEngine::expand_promotions(MoveList& moves) {
+    int promotions = 0;
+    for (int i = 0; i < moves.size(); i++) {
+        if (moves[i].flag() == PROMOTION_MOVE) promotions++;
+    }
+    if (promotions == 0) return;
+    // filled in from the back, so that every move is moved before its slot is overwritten
+    int n = moves.size() + 3 * promotions;
+    for (int i = moves.size() - 1; i >= 0; i--) {
+        BoardMove m = moves[i];
+        if (m.flag() == PROMOTION_MOVE) {
             // consider all types of promotions
-            for (PieceType pt : promote_to_pieces) {
-                Move nm = Move(m->move_from, m->move_to, m->piece_moved, m->piece_replaced, m->type);
-                nm.promote_to = pt;
-                first_pms.push_back(create_possible_move(
-                    other_color, nm, nm, 1,
-                    calculate_utility(nm, game), INT32_MIN, NULL
-                ));
+            for (int p = 3; p >= 0; p--) {
+                m.set_promote_to(promote_to_pieces[p]);
+                moves[--n] = m;
             }
         } else {
-            first_pms.push_back(create_possible_move(
-                other_color, *m, *m, 1,
-                calculate_utility(*m, game), INT32_MIN, NULL
-            ));
+            moves[--n] = m;
         }
     }
-    // sort for slightly better pruning
-    sort(first_pms.begin(), first_pms.end(), compare_possible_move);
-    for (auto pm = first_pms.begin(); pm != first_pms.end(); pm++) {
-        pm_stack.push(*pm);
+    moves.count += 3 * promotions;
+}
+
+void ChessEngine::make_search_move(const BoardMove& m, ChessGame* game) {
+    Move move = game->to_move(m);
+    game->move_valid(move);
+    if (m.flag() == PROMOTION_MOVE) {
+        game->promote_pawn(move.move_to, m.promote_to());
     }
-    moves_considered = 0;
-    while (!pm_stack.empty()) {
-        PossibleMove *pm = pm_stack.top();
-        Move move = pm->move;
-        if (pm->visited) {
-            pm_stack.pop();
-            game->undo_move();
-            PossibleMove* parent = pm->parent;
-            int negated_score = -pm->best_score;
-            // update best scores based on negamax
-            if (parent != NULL) {
-                parent->children_count--;
-                if (negated_score > parent->best_score) {
-                    parent->best_score = negated_score;
-                    if (pm->color == color) parent->predicted_move = pm->move;
+}
+
+long long ChessEngine::elapsed_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - search_start).count();
+}
+
+bool ChessEngine::aborted(const SearchThread& thread) {
+    if (stop_search.load(std::memory_order_relaxed)) return true;
+    for (const SearchThread* task = &thread; task->split != NULL; task = task->split->owner) {
+        if (task->split_index > task->split->cutoff_index.load(std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+bool ChessEngine::out_of_budget(SearchThread& thread) {
+    if (aborted(thread)) return true;
+    if (thread.id != 0 || !can_stop) return false;
+    // reading the clock (or the other threads' counters) is comparatively slow, so it is only done every 256 nodes
+    int nodes = thread.nodes.load(std::memory_order_relaxed);
+    if ((nodes & 255) != 0) return false;
+    if (active_limits.time_ms > 0 && elapsed_ms() >= active_limits.time_ms) stop_search = true;
+    if (active_limits.nodes > 0) {
+        long long total_nodes = parallel_nodes.load(std::memory_order_relaxed);
+        for (unsigned i = 0; parallel_search == LAZY_SMP && i < search_threads.size(); i++) {
+            total_nodes += search_threads[i]->nodes.load(std::memory_order_relaxed);
+        }
+        if (total_nodes >= active_limits.nodes) stop_search = true;
+    }
+    return stop_search;
+}
+
+int ChessEngine::order_score(SearchThread& thread, const BoardMove& m, int ply, bool losing_capture) {
+    const Position& position = thread.game->board->get_position();
+    int captured = captured_piece(position, m);
+    bool queen_promotion = m.flag() == PROMOTION_MOVE && m.promote_to() == QUEEN;
+    if (captured != NO_PIECE || queen_promotion) {
+        // most valuable victim first, and the least valuable attacker first among equal victims. A promotion gains a queen
+        int victim = (captured == NO_PIECE ? 0 : captured) + (queen_promotion ? QUEEN_INDEX : 0);
+        int mvv_lva = 8 * victim + KING_INDEX - Position::piece_type(position.piece_on(m.from()));
+        return (losing_capture ? LOSING_CAPTURE_ORDER : CAPTURE_ORDER) + mvv_lva;
+    }
+    uint16_t move = m.bits();
+    if (move == thread.killers[ply][0]) return KILLER_ORDER + 1;
+    if (move == thread.killers[ply][1]) return KILLER_ORDER;
+    return thread.history[Position::piece_color(position.piece_on(m.from()))][m.from()][m.to()];
+}
+
+int ChessEngine::reduction(SearchThread& thread, const BoardMove& m, bool quiet, bool losing_capture, int depth, int ply, int move_number,
+    bool in_check, bool gives_check) {
+    if (!(search_features & LATE_MOVE_REDUCTIONS) || depth < LMR_MIN_DEPTH || move_number < LMR_MIN_MOVE || in_check || gives_check) return 0;
+    if (!quiet) return losing_capture ? 1 : 0;
+    uint16_t move = m.bits();
+    if (move == thread.killers[ply][0] || move == thread.killers[ply][1]) return 0;
+    return move_number >= LMR_DEEP_MOVE && depth > LMR_MIN_DEPTH ? 2 : 1;
+}
+
+bool ChessEngine::has_non_pawn_material(const Position& position, int color) {
+    return (position.get_occupancy(color) & ~position.get_pieces(color, PAWN_INDEX) & ~position.get_pieces(color, KING_INDEX)) != EMPTY_BB;
+}
+
+void ChessEngine::record_cutoff(SearchThread& thread, const BoardMove& m, int depth, int ply, bool first_move) {
+    thread.cutoffs++;
+    if (first_move) thread.first_move_cutoffs++;
+    const Position& position = thread.game->board->get_position();
+    if (!is_quiet(position, m)) return;
+    uint16_t move = m.bits();
+    if (thread.killers[ply][0] != move) {
+        thread.killers[ply][1] = thread.killers[ply][0];
+        thread.killers[ply][0] = move;
+    }
+    int& score = thread.history[Position::piece_color(position.piece_on(m.from()))][m.from()][m.to()];
+    score += depth * depth;
+    if (score >= HISTORY_MAX) {
+        for (int c = 0; c < NUM_COLORS; c++) {
+            for (int from = 0; from < NUM_SQUARES; from++) {
+                for (int to = 0; to < NUM_SQUARES; to++) {
+                    thread.history[c][from][to] /= 2;
                 }
-                // alpha beta pruning
-                parent->alpha = max(parent->alpha, parent->best_score);
-                if (parent->alpha > parent->beta) {
-                    while (parent->children_count) {
-                        delete pm_stack.top();
-                        pm_stack.pop();
-                        parent->children_count--;
+            }
+        }
+    }
+}
+
+bool ChessEngine::probe_result(const SearchThread& thread, uint64_t key, TTEntry& entry) {
+    bool found = tt.probe(key, entry);
+    TTEntry candidate;
+    for (const SearchThread* task = &thread; task->split != NULL; task = task->split->owner) {
+        if (task->table->probe(key, candidate) && (!found || candidate.depth > entry.depth)) {
+            entry = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void ChessEngine::store_result(SearchThread& thread, uint64_t key, int depth, int bound, int score, uint16_t move) {
+    if (thread.split == NULL) tt.store(key, depth, bound, score, move);
+    else thread.table->store(key, depth, bound, score, move);
+}
+
+void ChessEngine::update_pv(SearchThread& thread, int ply, uint16_t move, const uint16_t* line, int length) {
+    thread.pv_table[ply][ply] = move;
+    for (int i = 0; i < length; i++) {
+        thread.pv_table[ply][ply + 1 + i] = line[i];
+    }
+    thread.pv_length[ply] = ply + 1 + (length > 0 ? length : 0);
+}
+
+int ChessEngine::search(SearchThread& thread, Color color, int depth, int alpha, int beta, int ply) {
+    thread.pv_length[ply] = ply;
+    if (out_of_budget(thread)) return 0;
+    bool in_check = thread.game->is_check(color);
+    // a side in check is not left to quiescence search, which does not look at check evasions and so could not see a mate
+    if (in_check && depth <= 0) depth = 1;
+    if (depth <= 0 || ply >= MAX_SEARCH_PLY - 1) return quiescence(thread, color, alpha, beta, ply);
+
+    uint64_t key = position_key(color, thread.game);
+    uint16_t hash_move = NO_TT_MOVE;
+    TTEntry entry;
+    if (probe_result(thread, key, entry)) {
+        hash_move = entry.move;
+        // the root always needs a move, so it is searched even if the stored result would do
+        if (ply > 0 && entry.depth >= depth && (
+            entry.bound() == BOUND_EXACT ||
+            (entry.bound() == BOUND_LOWER && score_from_tt(entry.score, ply) >= beta) ||
+            (entry.bound() == BOUND_UPPER && score_from_tt(entry.score, ply) <= alpha)
+        )) {
+            return score_from_tt(entry.score, ply);
+        }
+    }
+
+    Color other_color = get_other_color(color);
+    int eval = evaluate(thread, color);
+    // principal variation nodes are searched with an open window, and are never cut off on the static evaluation or by a null move
+    bool pv_node = beta - alpha > 1;
+    if (ply > 0 && !in_check && !pv_node) {
+        if ((search_features & REVERSE_FUTILITY_PRUNING) && depth <= REVERSE_FUTILITY_DEPTH && eval - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+            return eval;
+        }
+        if ((search_features & NULL_MOVE_PRUNING) && depth >= NULL_MOVE_MIN_DEPTH && eval >= beta && !thread.null_move[ply - 1]
+            && has_non_pawn_material(thread.game->board->get_position(), color_index(color))) {
+            // passing leaves the game as it is. En passant captures are only generated for the side that can make them
+            int r = depth >= NULL_MOVE_DEEP_DEPTH ? 3 : 2;
+            thread.null_move[ply] = true;
+            int score = -search(thread, other_color, depth - 1 - r, -beta, -beta + 1, ply + 1);
+            thread.null_move[ply] = false;
+            if (aborted(thread)) return 0;
+            if (score >= beta) return beta;
+        }
+    }
+
+    MoveList moves;
+    thread.game->get_all_valid_moves(color, moves);
+    // checkmate, counted from the root so that shorter mates score higher, or stalemate
+    if (moves.empty()) return in_check ? -MATE_SCORE + ply : 0;
+    expand_promotions(moves);
+
+    int alpha_orig = alpha;
+    int best_score = -SEARCH_INFINITY;
+    uint16_t best_move = NO_TT_MOVE;
+    // the hash move is searched first, and the other moves are only scored and sorted once it fails to cause a cutoff
+    int hash_index = -1;
+    if (hash_move != NO_TT_MOVE) {
+        for (int i = 0; i < moves.size(); i++) {
+            if (moves[i].bits() == hash_move) {
+                hash_index = i;
+                break;
+            }
+        }
+    }
+    // indices into moves in search order, the first ordered of them decided so far. Static exchange evaluation runs once per move, when
+    // the move is ordered, and its result is kept for the reduction
+    int order[MAX_MOVES], scores[MAX_MOVES];
+    bool losing[MAX_MOVES];
+    int ordered = 0;
+    const Position& position = thread.game->board->get_position();
+    if (hash_index >= 0) {
+        losing[hash_index] = is_losing_capture(position, moves[hash_index]);
+        order[ordered++] = hash_index;
+    }
+    for (int n = 0; n < moves.size(); n++) {
+        if (n == ordered) {
+            // ordering stage: every move not searched yet gets its ordering score, best first
+            int start = ordered;
+            for (int i = 0; i < moves.size(); i++) {
+                if (i == hash_index) continue;
+                losing[i] = is_losing_capture(position, moves[i]);
+                scores[i] = order_score(thread, moves[i], ply, losing[i]);
+                order[ordered++] = i;
+            }
+            sort(order + start, order + ordered, [&scores](int i1, int i2) { return scores[i1] > scores[i2]; });
+        }
+        if (n == 1 && parallel_search == YOUNG_BROTHERS_WAIT && depth >= YBWC_MIN_SPLIT_DEPTH) {
+            // the first move did not cause a cutoff, so the remaining moves are searched in parallel
+            Worker* worker = workers[thread.worker];
+            unsigned split_mark = worker->split_points.mark(), task_mark = worker->split_tasks.mark();
+            SplitPoint& sp = *worker->split_points.allocate();
+            sp.position = &thread.game->board->get_position();
+            sp.color = color;
+            sp.depth = depth;
+            sp.alpha = alpha;
+            sp.beta = beta;
+            sp.ply = ply;
+            sp.moves.clear();
+            sp.losing_captures.clear();
+            for (int i = n; i < ordered; i++) {
+                sp.moves.push_back(moves[order[i]].bits());
+                sp.losing_captures.push_back(losing[order[i]]);
+            }
+            split(thread, sp);
+            // results (and moves considered) are taken in move order up to the first cutoff, as a sequential search would
+            bool cutoff = false;
+            for (unsigned i = 0; i < sp.tasks.size(); i++) {
+                Task* task = sp.tasks[i];
+                if (!cutoff && !aborted(thread)) {
+                    thread.nodes += task->nodes;
+                    thread.cutoffs += task->cutoffs;
+                    thread.first_move_cutoffs += task->first_move_cutoffs;
+                    thread.eval_hits += task->eval_hits;
+                    thread.eval_misses += task->eval_misses;
+                    // the task's results are stored as if this thread had searched the move itself
+                    for (unsigned j = 0; j < task->results.size(); j++) {
+                        const TTEntry& e = task->results[j];
+                        store_result(thread, e.key, e.depth, e.bound(), e.score, e.move);
                     }
-                }
-            } else {
-                root_children_count--;
-                // update root best scores
-                if (negated_score > best_score) {
-                    best_score = negated_score;
-                    best_moves.clear();
-                    best_moves.push_back(*pm);
-                } else if (negated_score == best_score) {
-                    best_moves.push_back(*pm);
-                }
-                // alpha beta pruning, but on the root
-                root_alpha = max(root_alpha, best_score);
-                if (root_alpha > root_beta) {
-                    while (root_children_count) {
-                        delete pm_stack.top();
-                        pm_stack.pop();
-                        root_children_count--;
+                    int score = task->score;
+                    bool searched = false;
+                    if (score > sp.alpha && score < beta) {
+                        // the task only proved the move better than the alpha of the split, so the move is searched again as a sequential
+                        // search would: with a zero window if an earlier move raised alpha since, then with the full window
+                        const BoardMove& move = moves[order[n + i]];
+                        make_search_move(move, thread.game);
+                        if (alpha > sp.alpha) {
+                            score = -search(thread, other_color, depth - 1, -alpha - 1, -alpha, ply + 1);
+                        }
+                        if (score > alpha && score < beta) {
+                            score = -search(thread, other_color, depth - 1, -beta, -alpha, ply + 1);
+                        }
+                        thread.game->undo_move();
+                        if (aborted(thread)) break;
+                        searched = true;
+                    }
+                    if (score > best_score) {
+                        best_score = score;
+                        best_move = sp.moves[i];
+                        if (score > alpha) {
+                            alpha = score;
+                            if (searched) update_pv(thread, ply, best_move, thread.pv_table[ply + 1] + ply + 1, thread.pv_length[ply + 1] - ply - 1);
+                            else update_pv(thread, ply, best_move, task->line.data(), task->line.size());
+                            cutoff = alpha >= beta;
+                            if (cutoff) record_cutoff(thread, moves[order[n + i]], depth, ply, false);
+                        }
                     }
-                }
-                if (negated_score < worst_score) {
-                    worst_score = negated_score;
                 }
             }
-            delete pm;
-            moves_considered++;
+            worker->split_tasks.release(task_mark);
+            worker->split_points.release(split_mark);
+            if (aborted(thread)) return 0;
+            break;
+        }
+        const BoardMove& move = moves[order[n]];
+        bool quiet = is_quiet(position, move);
+        bool losing_capture = losing[order[n]];
+        make_search_move(move, thread.game);
+        bool gives_check = thread.game->is_check(other_color);
+        // a quiet move that gives check can still raise alpha through the threat, so it is never pruned
+        if ((search_features & FUTILITY_PRUNING) && ply > 0 && n > 0 && depth <= FUTILITY_DEPTH && !in_check && quiet && !gives_check
+            && eval + FUTILITY_MARGIN * depth <= alpha) {
+            thread.game->undo_move();
+            continue;
+        }
+        count_node(thread);
+        int score;
+        if (n == 0) {
+            score = -search(thread, other_color, depth - 1, -beta, -alpha, ply + 1);
         } else {
-            // move piece to find new possible moves
-            game->move_valid(move);
-            if (move.type == PAWN_PROMOTION) {
-                game->promote_pawn(move.move_to, move.promote_to);
+            // zero window search to prove the move is no better than alpha (reduced for late moves), and a full re-search if it is
+            int r = reduction(thread, move, quiet, losing_capture, depth, ply, n, in_check, gives_check);
+            score = -search(thread, other_color, depth - 1 - r, -alpha - 1, -alpha, ply + 1);
+            if (r > 0 && score > alpha) {
+                score = -search(thread, other_color, depth - 1, -alpha - 1, -alpha, ply + 1);
             }
-            // mark it visited so we revisit later and undo the move done
-            pm->visited = true;
-            // if we haven't reached all levels yet, then push all possible moves for next turn
-            if (pm->depth != level) {
-                // update to get the latest alphas and betas for pruning
-                if (pm->parent != NULL) {
-                    pm->alpha = -pm->parent->beta;
-                    pm->beta = -pm->parent->alpha;
-                } else {
-                    pm->alpha = -root_beta;
-                    pm->beta = -root_alpha;
-                }
-                vector<Move> possible_moves = game->get_all_valid_moves(pm->color);
-                // used later to keep track of how many of the children are still left in stack and potentially remove them
-                Color new_color = get_other_color(pm->color);
-                int sign = pm->color == color ? 1 : -1;
-                vector<PossibleMove*> pms;
-                for (auto m = possible_moves.begin(); m != possible_moves.end(); m++) {
-                    if (m->type == PAWN_PROMOTION) {
-                        // consider all promotion types
-                        for (PieceType pt : promote_to_pieces) {
-                            Move nm = *m;
-                            nm.promote_to = pt;
-                            pms.push_back(create_possible_move(
-                                new_color, pm->root, nm, pm->depth + 1, pm->score + sign * calculate_utility(nm, game), INT32_MIN, pm
-                            ));
-                        }
-                        pm->children_count += 4;
-                    } else {
-                        pms.push_back(create_possible_move(
-                            new_color, pm->root, *m, pm->depth + 1, pm->score + sign * calculate_utility(*m, game), INT32_MIN, pm
-                        ));
-                    }
-                }
-                pm->children_count = pms.size();
-                // if we have no possible moves, that means we've reached the end of a branch early
-                if (pm->children_count == 0) {
-                    // set the best_score with current sign (for negamax) and set its level to the highest (essentially marking it the end of branch)
-                    pm->best_score = (pm->color == color ? 1 : -1) * pm->score;
-                    pm->depth = level;
-                    continue;
-                }
-                // sorting them for slightly better pruning. Add to stack ascending or descending score based on color
-                // If our color, add them ascending (consider large options first, as we're maximizing).
-                // Vice versa, the other color is minimizing, so add them descending order to consider smaller options first
-                sort(pms.begin(), pms.end(), compare_possible_move);
-                auto start = pm->color == color ? pms.begin() : pms.end() - 1;
-                auto end = pm->color == color ? pms.end() : pms.begin() - 1;
-                int step = pm->color == color ? 1 : -1;
-                for (auto pm = start; pm != end; pm += step) {
-                    pm_stack.push(*pm);
+            if (score > alpha && score < beta) {
+                score = -search(thread, other_color, depth - 1, -beta, -alpha, ply + 1);
+            }
+        }
+        thread.game->undo_move();
+        // the score of an interrupted search is meaningless, and must not be stored
+        if (aborted(thread)) return 0;
+
+        if (score > best_score) {
+            best_score = score;
+            best_move = move.bits();
+            if (score > alpha) {
+                alpha = score;
+                // this move followed by the child's line is the new principal variation
+                update_pv(thread, ply, best_move, thread.pv_table[ply + 1] + ply + 1, thread.pv_length[ply + 1] - ply - 1);
+                if (alpha >= beta) {
+                    record_cutoff(thread, move, depth, ply, n == 0);
+                    break;
                 }
-            } else {
-                // we have reached all levels, simply set the best_score with current sign (for negamax)
-                pm->best_score = (pm->color == color ? 1 : -1) * pm->score;
             }
         }
     }
-    PossibleMove best_move = best_moves.at(random_number(0, best_moves.size()));
-    return best_move.root;
+
+    int bound = best_score >= beta ? BOUND_LOWER : best_score > alpha_orig ? BOUND_EXACT : BOUND_UPPER;
+    store_result(thread, key, depth, bound, score_to_tt(best_score, ply), best_move);
+    return best_score;
+}
+
+int ChessEngine::quiescence(SearchThread& thread, Color color, int alpha, int beta, int ply) {
+    if (out_of_budget(thread)) return 0;
+    int best_score = evaluate(thread, color);
+    if (best_score >= beta || ply >= MAX_SEARCH_PLY - 1) return best_score;
+    if (best_score > alpha) alpha = best_score;
+
+    MoveList moves;
+    thread.game->get_all_valid_moves(color, moves);
+    const Position& position = thread.game->board->get_position();
+    // the captures worth searching are moved to the front of the list
+    int captures = 0;
+    int order[MAX_MOVES], scores[MAX_MOVES];
+    for (int i = 0; i < moves.size(); i++) {
+        BoardMove move = moves[i];
+        int captured = captured_piece(position, move);
+        if (captured == NO_PIECE && move.flag() != PROMOTION_MOVE) continue;
+        int gain = captured == NO_PIECE ? 0 : Evaluation::piece_values[captured];
+        if (move.flag() == PROMOTION_MOVE) {
+            // under-promotions are left to the full width search
+            move.set_promote_to(QUEEN);
+            gain += Evaluation::piece_values[QUEEN_INDEX] - Evaluation::piece_values[PAWN_INDEX];
+        }
+        if (best_score + gain + DELTA_MARGIN <= alpha) continue;
+        // captures that lose material once the exchange is played out are not worth searching
+        if (is_losing_capture(position, move)) continue;
+        scores[captures] = order_score(thread, move, ply, false);
+        order[captures] = captures;
+        moves[captures++] = move;
+    }
+    sort(order, order + captures, [&scores](int i1, int i2) { return scores[i1] > scores[i2]; });
+
+    Color other_color = get_other_color(color);
+    for (int n = 0; n < captures; n++) {
+        make_search_move(moves[order[n]], thread.game);
+        count_node(thread);
+        int score = -quiescence(thread, other_color, -beta, -alpha, ply + 1);
+        thread.game->undo_move();
+        if (aborted(thread)) return 0;
+
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+    return best_score;
+}
+
+void ChessEngine::split(SearchThread& thread, SplitPoint& sp) {
+    sp.owner = &thread;
+    sp.cutoff_index = sp.moves.size();
+    sp.finished = 0;
+    sp.tasks.clear();
+    Worker* worker = workers[thread.worker];
+    for (unsigned i = 0; i < sp.moves.size(); i++) {
+        Task* task = worker->split_tasks.allocate();
+        task->split = &sp;
+        task->index = i;
+        task->score = 0;
+        task->nodes = 0;
+        task->cutoffs = 0;
+        task->first_move_cutoffs = 0;
+        task->eval_hits = 0;
+        task->eval_misses = 0;
+        task->line.clear();
+        task->results.clear();
+        sp.tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> guard(worker->lock);
+        // the owner takes tasks from the back, so it starts with the most promising moves, while other workers steal the least promising ones
+        for (int i = sp.tasks.size() - 1; i >= 0; i--) {
+            worker->tasks.push_back(sp.tasks[i]);
+        }
+    }
+    while (sp.finished.load(std::memory_order_acquire) < (int) sp.tasks.size()) {
+        Task* task = pop_task(thread.worker, &sp);
+        // once its own tasks are taken, the owner helps other workers instead of waiting for its tasks to finish
+        if (task == NULL) task = steal_task(thread.worker);
+        if (task != NULL) run_task(*task, thread.worker);
+#ifndef __EMSCRIPTEN__
+        else std::this_thread::yield();
+#endif
+    }
+}
+
+void ChessEngine::run_task(Task& task, int worker) {
+    SplitPoint& sp = *task.split;
+    Worker* w = workers[worker];
+    unsigned thread_mark = w->task_threads.mark();
+    SearchThread& thread = *w->task_threads.allocate();
+    reset_thread(thread, sp.owner->id);
+    thread.split = &sp;
+    thread.split_index = task.index;
+    thread.worker = worker;
+    thread.pawns = pawn_tables[worker];
+    if (!aborted(thread)) {
+        thread.game = thread_game(thread, *sp.position);
+        if (thread.table == NULL) thread.table = new TaskTable();
+        thread.table->clear();
+        // the owner does not update its killer and history tables while waiting for its tasks, so every task starts with the same ones
+        memcpy(thread.killers, sp.owner->killers, sizeof(thread.killers));
+        memcpy(thread.history, sp.owner->history, sizeof(thread.history));
+        // the packed move names squares rather than pieces, so it applies to the task's own game as it is
+        BoardMove m = BoardMove::from_bits(sp.moves[task.index]);
+        Color other_color = get_other_color(sp.color);
+        bool in_check = thread.game->is_check(sp.color);
+        bool quiet = is_quiet(thread.game->board->get_position(), m);
+        bool losing_capture = sp.losing_captures[task.index];
+
+        make_search_move(m, thread.game);
+        count_node(thread);
+        // searched like the owner would search it: the first move of the split point is the owner's second move
+        int r = reduction(thread, m, quiet, losing_capture, sp.depth, sp.ply, task.index + 1, in_check, thread.game->is_check(other_color));
+        int score = -search(thread, other_color, sp.depth - 1 - r, -sp.alpha - 1, -sp.alpha, sp.ply + 1);
+        if (r > 0 && score > sp.alpha) {
+            score = -search(thread, other_color, sp.depth - 1, -sp.alpha - 1, -sp.alpha, sp.ply + 1);
+        }
+        // the full window re-search of a move that beats alpha is left to the owner, which by then knows the alpha of the moves before it
+        thread.game->undo_move();
+        if (!aborted(thread)) {
+            // the thread state goes back to the worker once the task is done, so the owner gets a copy of what it needs
+            task.score = score;
+            task.nodes = thread.nodes;
+            task.cutoffs = thread.cutoffs;
+            task.first_move_cutoffs = thread.first_move_cutoffs;
+            task.eval_hits = thread.eval_hits;
+            task.eval_misses = thread.eval_misses;
+            int ply = sp.ply + 1;
+            task.line.assign(thread.pv_table[ply] + ply, thread.pv_table[ply] + (thread.pv_length[ply] > ply ? thread.pv_length[ply] : ply));
+            thread.table->collect(task.results, YBWC_TASK_RESULTS);
+            if (score >= sp.beta) {
+                // cancels every task after this one
+                int cutoff = sp.cutoff_index.load();
+                while (task.index < cutoff && !sp.cutoff_index.compare_exchange_weak(cutoff, task.index)) {}
+            }
+        }
+    }
+    w->task_threads.release(thread_mark);
+    sp.finished.fetch_add(1, std::memory_order_release);
+}
+
+void ChessEngine::reset_thread(SearchThread& thread, int id) {
+    thread.id = id;
+    thread.game = NULL;
+    thread.split = NULL;
+    thread.split_index = 0;
+    thread.worker = 0;
+    thread.nodes = 0;
+    thread.depth_reached = 0;
+    thread.cutoffs = 0;
+    thread.first_move_cutoffs = 0;
+    thread.eval_hits = 0;
+    thread.eval_misses = 0;
+    memset(thread.null_move, 0, sizeof(thread.null_move));
+    thread.line.clear();
+    thread.pawns = NULL;
+}
+
+ChessGame* ChessEngine::thread_game(SearchThread& thread, const Position& position) {
+    if (thread.own_game == NULL) thread.own_game = new ChessGame(position);
+    else thread.own_game->set_position(position);
+    return thread.own_game;
+}
+
+ChessEngine::Task* ChessEngine::pop_task(int worker, SplitPoint* sp) {
+    Worker* w = workers[worker];
+    std::lock_guard<std::mutex> guard(w->lock);
+    if (w->tasks.empty() || w->tasks.back()->split != sp) return NULL;
+    Task* task = w->tasks.back();
+    w->tasks.pop_back();
+    return task;
+}
+
+ChessEngine::Task* ChessEngine::steal_task(int worker) {
+    for (unsigned i = 1; i < workers.size(); i++) {
+        Worker* w = workers[(worker + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(w->lock);
+        if (!w->tasks.empty()) {
+            Task* task = w->tasks.front();
+            w->tasks.pop_front();
+            return task;
+        }
+    }
+    return NULL;
+}
+
+void ChessEngine::worker_loop(int worker) {
+    while (pool_running.load(std::memory_order_acquire)) {
+        Task* task = steal_task(worker);
+        if (task != NULL) run_task(*task, worker);
+#ifndef __EMSCRIPTEN__
+        else std::this_thread::yield();
+#endif
+    }
+}
+
+void ChessEngine::iterative_deepening(SearchThread* thread, Color color, int max_depth) {
+    for (int depth = thread->id == 0 ? 1 : 1 + thread->id % 2; depth <= max_depth; depth++) {
+        search(*thread, color, depth, -SEARCH_INFINITY, SEARCH_INFINITY, 0);
+        // an unfinished iteration is thrown away, the previous principal variation is kept
+        if (stop_search) break;
+        thread->line.assign(thread->pv_table[0], thread->pv_table[0] + thread->pv_length[0]);
+        thread->depth_reached = depth;
+        if (thread->id == 0) {
+            can_stop = true;
+            // the next iteration takes several times longer than this one, so it is not started if it is unlikely to finish
+            if (active_limits.time_ms > 0 && elapsed_ms() * 2 >= active_limits.time_ms) break;
+        }
+    }
+    // helper threads stop as soon as the main thread is done
+    if (thread->id == 0) stop_search = true;
+}
+
+void ChessEngine::build_principal_variation(Color color, ChessGame* game, const vector<uint16_t>& line) {
+    principal_variation.clear();
+    for (unsigned ply = 0; ply < line.size(); ply++) {
+        MoveList moves;
+        game->get_all_valid_moves(color, moves);
+        expand_promotions(moves);
+        const BoardMove* m = moves.begin();
+        while (m != moves.end() && m->bits() != line[ply]) m++;
+        if (m == moves.end()) break;
+        Move move = game->to_move(*m);
+        move.promote_to = m->promote_to();
+        principal_variation.push_back(move);
+        make_search_move(*m, game);
+        color = get_other_color(color);
+    }
+    for (unsigned i = 0; i < principal_variation.size(); i++) {
+        game->undo_move();
+    }
+}
+
+#pragma endregion CHESS_ENGINE_PRIVATE
+
+#pragma region CHESS_ENGINE_PUBLIC
+
+ChessEngine::ChessEngine() : ChessEngine(0) {}
+ChessEngine::ChessEngine(int level) : ChessEngine(level, DEFAULT_TT_SIZE_MB) {}
+ChessEngine::ChessEngine(int level, int hash_size_mb) : ChessEngine(level, hash_size_mb, LAZY_SMP) {}
+ChessEngine::ChessEngine(int level, int hash_size_mb, ParallelSearch parallel_search)
+    : level(level), moves_considered(0), search_features(ALL_SEARCH_FEATURES), threads(1), parallel_search(parallel_search), stop_search(false), can_stop(false), depth_reached(0),
+    rng(mt19937(rd())), tt(hash_size_mb), network(NULL), pool_running(false), parallel_nodes(0), pawn_hash_hits(0), pawn_hash_misses(0), cutoffs(0), first_move_cutoffs(0),
+    eval_cache_hits(0), eval_cache_misses(0) {}
+
+ChessEngine::~ChessEngine() {
+    delete network;
+    for (unsigned i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+    for (unsigned i = 0; i < pawn_tables.size(); i++) {
+        delete pawn_tables[i];
+    }
+}
+
+Move ChessEngine::generate_random_move(Color color, ChessGame* game) {
+    vector<Move> possible_moves = game->get_all_valid_moves(color);
+    moves_considered = possible_moves.size();
+    Move move = possible_moves.at(random_number(0, possible_moves.size()));
+    if (move.type == PAWN_PROMOTION) {
+        move.promote_to = promote_to_pieces[random_number(0, 4)];
+    }
+    return move;
+}
+
+Move ChessEngine::generate_move(Color color, ChessGame* game) { return generate_move(color, game, limits); }
+Move ChessEngine::generate_move(Color color, ChessGame* game, SearchLimits search_limits) {
+    depth_reached = 0;
+    cutoffs = 0;
+    first_move_cutoffs = 0;
+    eval_cache_hits = 0;
+    eval_cache_misses = 0;
+    pawn_hash_hits = 0;
+    pawn_hash_misses = 0;
+    if (level <= 0) return generate_random_move(color, game);
+    tt.new_search();
+    moves_considered = 0;
+    active_limits = search_limits;
+    search_start = std::chrono::steady_clock::now();
+    stop_search = false;
+    can_stop = false;
+    int max_depth = level < MAX_SEARCH_PLY - 1 ? level : MAX_SEARCH_PLY - 1;
+    if (search_limits.depth > 0 && search_limits.depth < max_depth) max_depth = search_limits.depth;
+
+    // the main thread searches the caller's game. Lazy SMP helper threads get copies of it, while pool workers of the young brothers
+    // wait search set up a game for every task they run
+#ifdef __EMSCRIPTEN__
+    int num_threads = 1;
+#else
+    int num_threads = threads;
+#endif
+    while ((int) pawn_tables.size() < num_threads) {
+        pawn_tables.push_back(new PawnHashTable());
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pawn_tables[i]->reset_stats();
+    }
+    // the game position keeps the network's accumulators up to date while searching, and copies of it for other threads do as well
+    game->board->get_position().set_network(network);
+    int num_search_threads = parallel_search == LAZY_SMP ? num_threads : 1;
+    for (int i = 0; i < num_search_threads; i++) {
+        SearchThread* thread = search_thread_arena.allocate();
+        reset_thread(*thread, i);
+        memset(thread->killers, 0, sizeof(thread->killers));
+        memset(thread->history, 0, sizeof(thread->history));
+        thread->game = i == 0 ? game : thread_game(*thread, game->board->get_position());
+        thread->pawns = pawn_tables[i];
+        search_threads.push_back(thread);
+    }
+    if (parallel_search == YOUNG_BROTHERS_WAIT) {
+        parallel_nodes = 0;
+        while ((int) workers.size() < num_threads) {
+            workers.push_back(new Worker());
+        }
+    }
+    pool_running = true;
+#ifndef __EMSCRIPTEN__
+    vector<std::thread> helpers;
+    for (int i = 1; i < num_threads; i++) {
+        if (parallel_search == LAZY_SMP) helpers.push_back(std::thread(&ChessEngine::iterative_deepening, this, search_threads[i], color, max_depth));
+        else helpers.push_back(std::thread(&ChessEngine::worker_loop, this, i));
+    }
+#endif
+    iterative_deepening(search_threads[0], color, max_depth);
+    pool_running = false;
+#ifndef __EMSCRIPTEN__
+    for (unsigned i = 0; i < helpers.size(); i++) {
+        helpers[i].join();
+    }
+#endif
+    // the move comes from the deepest completed iteration of any thread, preferring the main thread
+    SearchThread* best_thread = search_threads[0];
+    for (unsigned i = 0; i < search_threads.size(); i++) {
+        SearchThread* thread = search_threads[i];
+        if (thread->depth_reached > best_thread->depth_reached) best_thread = thread;
+        moves_considered += thread->nodes;
+        cutoffs += thread->cutoffs;
+        first_move_cutoffs += thread->first_move_cutoffs;
+        eval_cache_hits += thread->eval_hits;
+        eval_cache_misses += thread->eval_misses;
+    }
+    depth_reached = best_thread->depth_reached;
+    for (int i = 0; i < num_threads; i++) {
+        pawn_hash_hits += pawn_tables[i]->get_hits();
+        pawn_hash_misses += pawn_tables[i]->get_misses();
+    }
+    build_principal_variation(color, game, best_thread->line);
+    game->board->get_position().set_network(NULL);
+    search_threads.clear();
+    search_thread_arena.reset();
+    return principal_variation.at(0);
+}
+
+vector<Move> ChessEngine::get_principal_variation() { return principal_variation; }
+double ChessEngine::get_first_move_cutoff_rate() { return cutoffs == 0 ? 0 : (double) first_move_cutoffs / cutoffs; }
+long long ChessEngine::get_eval_cache_hits() { return eval_cache_hits; }
+long long ChessEngine::get_eval_cache_misses() { return eval_cache_misses; }
+double ChessEngine::get_pawn_hash_hit_rate() {
+    long long lookups = pawn_hash_hits + pawn_hash_misses;
+    return lookups == 0 ? 0 : (double) pawn_hash_hits / lookups;
+}
+
+int ChessEngine::evaluate(Color color, ChessGame* game) {
+    Position& position = game->board->get_position();
+    if (network != NULL) {
+        int us = color_index(color);
+        position.set_network(network);
+        int score = Nnue::evaluate(*network, position.get_accumulator(us), position.get_accumulator(us ^ 1));
+        position.set_network(NULL);
+        return score;
+    }
+    int pawn_scores[Evaluation::NUM_PHASES];
+    Evaluation::evaluate_pawns(position, pawn_scores);
+    return evaluate(color, position, pawn_scores);
 }
 
 int ChessEngine::calculate_utility(Move m, ChessGame* game) {
     Piece* moved = m.piece_moved;
     Piece* captured = m.piece_replaced;
     Color other = get_other_color(moved->color);
-    int old_mobility = game->get_moves(m.piece_replaced).size();
-    int old_position_value = moved->get_square_table_value(is_end_game(game));
+    const Position& position = game->board->get_position();
+    int from = make_square(m.move_from.x, m.move_from.y), to = make_square(m.move_to.x, m.move_to.y);
+    // mobility of the moving piece, from its attacks
+    int old_mobility = Evaluation::mobility(position, from);
+    int old_position_value = Evaluation::taper(
+        moved->get_square_table_value(false), moved->get_square_table_value(true), position.get_phase()
+    );
     int score = 0;
     int material = 0;
     // temporary move piece to check mobility and other factors
@@ -214,33 +831,56 @@ int ChessEngine::calculate_utility(Move m, ChessGame* game) {
     else if (game->is_stalemate(other)) score = 100;
     else {
         material += captured == NULL ? 0 : captured->get_material_value();
-        int mobility = game->get_moves(m.piece_replaced).size() - old_mobility;
-        int center_value = center_distance_scores[8 * m.move_to.y + m.move_to.x] - center_distance_scores[8 * m.move_from.y + m.move_from.x];
-        int position_value = moved->get_square_table_value(is_end_game(game)) - old_position_value;
+        int mobility = Evaluation::mobility(position, to) - old_mobility;
+        int center_value = center_distance_scores[to] - center_distance_scores[from];
+        int position_value = Evaluation::taper(
+            moved->get_square_table_value(false), moved->get_square_table_value(true), position.get_phase()
+        ) - old_position_value;
         score = 7 * material + center_value + mobility + 1.5 * position_value;
     }
     game->undo_move();
     return score;
 }
 
-bool ChessEngine::is_end_game(ChessGame* game) {
-    vector<Piece*> white_pieces = game->board->get_pieces(WHITE);
-    vector<Piece*> black_pieces = game->board->get_pieces(BLACK);
-    int white_values = 0, black_values = 0;
-    for (auto pa = white_pieces.begin(); pa != white_pieces.end(); pa++) {
-        Piece* p = *pa;
-        if (p->type != KING) white_values += p->get_material_value();
-    }
-    for (auto pa = black_pieces.begin(); pa != black_pieces.end(); pa++) {
-        Piece* p = *pa;
-        if (p->type != KING) black_values += p->get_material_value();
-    }
-    int count_diff = white_pieces.size() - black_pieces.size();
-    return abs(white_values - black_values) >= 10 || abs(count_diff) > 10;
-}
+bool ChessEngine::is_end_game(ChessGame* game) { return 2 * game->board->get_position().get_phase() <= Evaluation::TOTAL_PHASE; }
 
 void ChessEngine::set_level(int new_level) { level = new_level < 0 ? 0 : new_level; }
 int ChessEngine::get_level() { return level; }
 int ChessEngine::get_moves_considered() { return moves_considered; }
 
+void ChessEngine::set_limits(SearchLimits new_limits) { limits = new_limits; }
+SearchLimits ChessEngine::get_limits() { return limits; }
+int ChessEngine::get_depth_reached() { return depth_reached; }
+
+void ChessEngine::set_search_features(int features) { search_features = features & ALL_SEARCH_FEATURES; }
+int ChessEngine::get_search_features() { return search_features; }
+
+void ChessEngine::set_threads(int new_threads) { threads = new_threads < 1 ? 1 : new_threads; }
+int ChessEngine::get_threads() { return threads; }
+ParallelSearch ChessEngine::get_parallel_search() { return parallel_search; }
+
+void ChessEngine::set_hash_size(int size_mb) { tt.resize(size_mb); }
+int ChessEngine::get_hash_size() { return tt.get_size_mb(); }
+void ChessEngine::clear_hash() { tt.clear(); }
+bool ChessEngine::load_network(const string& path) {
+    Nnue::Network* loaded = Nnue::load(path);
+    if (loaded == NULL) return false;
+    delete network;
+    network = loaded;
+    eval_cache.clear();
+    return true;
+}
+
+void ChessEngine::unload_network() {
+    if (network == NULL) return;
+    delete network;
+    network = NULL;
+    eval_cache.clear();
+}
+
+bool ChessEngine::has_network() { return network != NULL; }
+
+void ChessEngine::set_eval_cache_size(int size_mb) { eval_cache.resize(size_mb); }
+int ChessEngine::get_eval_cache_size() { return eval_cache.get_size_mb(); }
+
 #pragma endregion CHESS_ENGINE_PUBLIC
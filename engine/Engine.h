@@ -3,16 +3,112 @@
 
 #include "Game.h"
 #include "Util/Move.h"
+#include "Search/TranspositionTable.h"
+#include "Search/PawnHashTable.h"
+#include "Search/EvalCache.h"
+#include "Search/TaskTable.h"
+#include "Search/Arena.h"
 #include <random>
-#include <stack>
 #include <algorithm>
-using std::stack;
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <deque>
 using std::sort;
 using std::random_device;
 using std::mt19937;
 using std::uniform_int_distribution;
 using std::max;
 
+// Maximum search depth in plies
+#define MAX_SEARCH_PLY 64
+// the moves a search makes on top of a game of MAX_GAME_MOVES have to fit on its undo stacks
+static_assert(MAX_SEARCH_PLY <= HISTORY_CAPACITY - MAX_GAME_MOVES, "search line does not fit on the undo stacks");
+// Larger than any score the search can produce
+#define SEARCH_INFINITY 1000000
+// Score of being checkmated at the root. Being mated n plies from the root scores n more
+#define MATE_SCORE 100000
+// Scores at least this far from 0 are mates
+#define MATE_BOUND (MATE_SCORE - MAX_SEARCH_PLY)
+// Most a capture can gain in evaluation on top of the captured material, used for delta pruning in quiescence search
+#define DELTA_MARGIN 100
+// Move ordering scores (see ChessEngine::order_score): captures and queen promotions come first, then killer moves, then quiet moves by history,
+// then captures that lose material
+#define CAPTURE_ORDER 2000000
+#define KILLER_ORDER 1000000
+#define LOSING_CAPTURE_ORDER (-CAPTURE_ORDER)
+// History scores are halved once one of them reaches this, so they stay below KILLER_ORDER and favor recent cutoffs
+#define HISTORY_MAX 100000
+// Selective search (see SearchFeature). Margins are on the evaluation scale, where a pawn is worth 70 (see Evaluation.h)
+#define NULL_MOVE_MIN_DEPTH 3
+// the null move reduction is one ply larger from this depth on (adaptive null move pruning)
+#define NULL_MOVE_DEEP_DEPTH 7
+#define REVERSE_FUTILITY_DEPTH 3
+#define REVERSE_FUTILITY_MARGIN 70
+#define FUTILITY_DEPTH 2
+#define FUTILITY_MARGIN 70
+#define LMR_MIN_DEPTH 3
+// moves are reduced from the LMR_MIN_MOVE-th move searched at a node, and by one more ply from the LMR_DEEP_MOVE-th
+#define LMR_MIN_MOVE 3
+#define LMR_DEEP_MOVE 6
+// Smallest remaining depth at which the parallel search hands moves out as tasks (see YOUNG_BROTHERS_WAIT)
+#define YBWC_MIN_SPLIT_DEPTH 3
+// Most transposition table entries a finished task passes on to the owner of its split point (the deepest of them, see TaskTable::collect)
+#define YBWC_TASK_RESULTS 1024
+
+/*
+ * Selective search techniques, stored as a bitmask inside ChessEngine (see ChessEngine::set_search_features). All are enabled by default
+*/
+enum SearchFeature {
+    /*
+     * When the line so far already reaches beta, the side to move passes, and the node is cut off if a reduced search still reaches beta
+     * (https://www.chessprogramming.org/Null_Move_Pruning). Skipped at principal variation nodes, when in check, right after another null move, and when the side to move
+     * only has pawns left, where passing could be better than any move (zugzwang)
+    */
+    NULL_MOVE_PRUNING = 1,
+    // Quiet moves late in the move order are searched with less depth first, and only searched fully if they turn out better than alpha
+    LATE_MOVE_REDUCTIONS = 2,
+    // Near the leaves, quiet moves that do not give check and whose utility is too far below alpha to raise it are not searched
+    FUTILITY_PRUNING = 4,
+    // Near the leaves, zero window nodes where the line so far is far enough above beta are cut off without searching any move
+    REVERSE_FUTILITY_PRUNING = 8,
+    ALL_SEARCH_FEATURES = 15
+};
+
+/*
+ * How the engine searches with more than one thread (see ChessEngine::set_threads)
+*/
+enum ParallelSearch {
+    /*
+     * Every thread searches the whole tree on its own, and the threads help each other through the shared transposition table
+     * (https://www.chessprogramming.org/Lazy_SMP). The moves found and moves considered depend on thread timing
+    */
+    LAZY_SMP,
+    /*
+     * Young brothers wait concept (https://www.chessprogramming.org/Young_Brothers_Wait_Concept). Once the first move of a node has
+     * been searched, the remaining moves are handed out as tasks to a pool of threads that steal work from each other
+     * The moves found and moves considered are the same on every run and with any number of threads, unless a time or node limit stops the search
+    */
+    YOUNG_BROTHERS_WAIT
+};
+
+/*
+ * Budget for a single generate_move call. A limit of 0 means unlimited
+ * The search deepens one ply at a time until the engine level is reached or a limit runs out, and then returns the best move
+ * of the deepest search that completed. The first ply is always searched fully, so a move is returned even with tiny limits
+*/
+struct SearchLimits {
+    // maximum depth in plies (the engine level caps it as well)
+    int depth;
+    // wall-clock time in milliseconds
+    int time_ms;
+    // maximum number of moves considered
+    long long nodes;
+
+    SearchLimits() : depth(0), time_ms(0), nodes(0) {}
+    SearchLimits(int depth, int time_ms, long long nodes) : depth(depth), time_ms(time_ms), nodes(nodes) {}
+};
+
 class ChessGame;
 /*
  * Represents a chess game, with functions to move chess pieces and uphold the rules of chess (e.g. check, checkmate, turns)
@@ -22,8 +118,31 @@ class ChessEngine {
 private:
     int level;
     int moves_considered;
+    // limits used when generate_move is not given any
+    SearchLimits limits;
+
+    // enabled SearchFeatures
+    int search_features;
+    // number of search threads (see set_threads), and how they are used
+    int threads;
+    ParallelSearch parallel_search;
+
+    // state of the running search
+    SearchLimits active_limits;
+    std::chrono::steady_clock::time_point search_start;
+    // set once a limit runs out (or the main thread is done), after which every search call returns immediately
+    std::atomic<bool> stop_search;
+    // false while the main thread searches the first iteration, which always completes
+    bool can_stop;
+    int depth_reached;
     random_device rd;
     mt19937 rng;
+    // search results, kept between calls to generate_move so the next search can reuse them
+    TranspositionTable tt;
+    // static evaluations of positions for the side to move, shared by all search threads and kept between calls to generate_move
+    EvalCache eval_cache;
+    // network evaluating positions instead of the hand-written evaluation (see load_network), or NULL
+    Nnue::Network* network;
 
     // Used for move evaluation. Values based on https://www.chessprogramming.org/Center_Manhattan-Distance, and inversed to appropriately show scores
     const int center_distance_scores[64] = {
@@ -40,27 +159,263 @@ private:
     // Returns random integer from [n1, n2)
     int random_number(int n1, int n2);
 
-    // Structure for storing next possible move. Used for move generation
-    struct PossibleMove {
+    struct SplitPoint;
+    /*
+     * State of one search thread. Every thread searches its own game, and threads only share the transposition table
+     * Thread 0 is the main thread: it searches the caller's game and is the only one checking the search limits
+     *
+     * Tasks of a YOUNG_BROTHERS_WAIT search are searched on a thread state of their own as well, so that the result of a task does not
+     * depend on the thread running it. They belong to the main thread's search (id 0)
+     *
+     * Threads come from arenas and are reused by later searches and tasks (see reset_thread)
+    */
+    struct SearchThread {
+        int id;
+        ChessGame* game;
+        // game of the thread's own, for threads not searching the caller's game. Created the first time it is needed (see thread_game)
+        ChessGame* own_game;
+        // split point of the task the thread is searching and the index of its move there, or NULL outside of tasks
+        SplitPoint* split;
+        int split_index;
+        // pool worker currently running the thread's search (0 for the main thread)
+        int worker;
+        // moves made by this thread. Only written by the thread itself, and read by the main thread to check the node limit
+        std::atomic<int> nodes;
+        int depth_reached;
+        /*
+         * Triangular principal variation table (https://www.chessprogramming.org/Triangular_PV-Table), holding packed moves
+         * pv_table[ply] is the best line found from ply onwards, pv_length[ply] its end
+        */
+        uint16_t pv_table[MAX_SEARCH_PLY][MAX_SEARCH_PLY];
+        int pv_length[MAX_SEARCH_PLY];
+        // whether the move made at each ply was a null move
+        bool null_move[MAX_SEARCH_PLY];
+        // two most recent quiet moves that caused a cutoff at each ply (https://www.chessprogramming.org/Killer_Heuristic), packed
+        uint16_t killers[MAX_SEARCH_PLY][2];
+        // history heuristic (https://www.chessprogramming.org/History_Heuristic): how often a quiet move by a color index from one square
+        // to another caused a cutoff, weighted by depth
+        int history[NUM_COLORS][NUM_SQUARES][NUM_SQUARES];
+        // cutoffs in the full width search, and how many of them were caused by the first move searched
+        int cutoffs;
+        int first_move_cutoffs;
+        // static evaluations found in and missing from the evaluation cache
+        int eval_hits;
+        int eval_misses;
+        // principal variation of the deepest completed iteration
+        vector<uint16_t> line;
+        // results of the task being searched (see store_result). Created the first time the thread searches a task, and cleared for every task
+        TaskTable* table;
+        // pawn hash table of the OS thread running the thread's search (see pawn_tables)
+        PawnHashTable* pawns;
+
+        ~SearchThread() {
+            delete own_game;
+            delete table;
+        }
+    };
+    // search threads of Lazy SMP searches, handed out again for every search
+    Arena<SearchThread> search_thread_arena;
+    // threads of the running search
+    vector<SearchThread*> search_threads;
+
+    /*
+     * Move of a YOUNG_BROTHERS_WAIT split point searched as a task, and what the owner of the split point needs of its result. The task
+     * is searched on a thread state the worker running it hands out only for that long (see run_task), so split points waiting for their
+     * tasks do not hold on to whole thread states
+    */
+    struct Task {
+        SplitPoint* split;
+        int index;
+        // zero window score of the move, for the side to move at the split point
+        int score;
+        int nodes;
+        int cutoffs;
+        int first_move_cutoffs;
+        int eval_hits;
+        int eval_misses;
+        // principal variation following the move
+        vector<uint16_t> line;
+        // deepest results the task searched, left for the owner of the split point to store
+        vector<TTEntry> results;
+    };
+    /*
+     * Node of a YOUNG_BROTHERS_WAIT search whose remaining moves are searched as tasks, all with a zero window at the alpha the node had
+     * once its first move was searched. The owner combines the results in move order, searching the moves that beat that alpha again
+     * itself, so they are the same whichever task finishes first
+    */
+    struct SplitPoint {
+        SearchThread* owner;
+        // position of the node, from which every task sets up its own game. The owner's game, which stays at the node until all tasks are done
+        const Position* position;
         Color color;
-        Move root, move, predicted_move;
-        int depth, score, best_score, children_count;
-        bool visited = false;
-        int alpha = INT16_MIN, beta = INT16_MAX;
-        PossibleMove* parent;
+        int depth;
+        int alpha;
+        int beta;
+        int ply;
+        // packed moves of the tasks, in search order, and whether each is a capture losing material (see is_losing_capture)
+        vector<uint16_t> moves;
+        vector<bool> losing_captures;
+        vector<Task*> tasks;
+        // index of the first task whose move caused a cutoff. Tasks after it are cancelled
+        std::atomic<int> cutoff_index;
+        std::atomic<int> finished;
     };
+    /*
+     * Work-stealing deque of a pool worker (https://www.chessprogramming.org/Work-Stealing). A worker adds the tasks of its split
+     * points to the back and takes them from the back, while idle workers steal from the front
+     *
+     * Split points and tasks a worker creates come from its arenas. They are released as soon as the split point is done, which is always
+     * in the reverse order they were created, since a worker only creates split points deeper in its own search. The same goes for the
+     * thread states of the tasks it runs, since a worker only runs a task within another one while that one waits at a split point
+     * Workers and their arenas are kept for later searches
+    */
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task*> tasks;
+        Arena<SplitPoint> split_points;
+        Arena<Task> split_tasks;
+        Arena<SearchThread> task_threads;
+    };
+    vector<Worker*> workers;
+    // true while pool workers should keep looking for tasks
+    std::atomic<bool> pool_running;
+    // every move made by a YOUNG_BROTHERS_WAIT search, including those of cancelled tasks, for the node limit
+    std::atomic<long long> parallel_nodes;
+
+    // one pawn hash table per OS thread searching (Lazy SMP threads by id, pool workers by index), kept between calls to generate_move
+    vector<PawnHashTable*> pawn_tables;
+    // pawn hash table lookups of the last generate_move call (see get_pawn_hash_hit_rate)
+    long long pawn_hash_hits;
+    long long pawn_hash_misses;
 
-    // Creates a possible move
-    PossibleMove* create_possible_move(Color color, Move root, Move move, int depth, int score, int best_score, PossibleMove* parent);
+    // principal variation of the last generate_move call
+    vector<Move> principal_variation;
+    // cutoff counts of the last generate_move call (see get_first_move_cutoff_rate)
+    long long cutoffs;
+    long long first_move_cutoffs;
+    // evaluation cache lookups of the last generate_move call, counted like the moves considered
+    long long eval_cache_hits;
+    long long eval_cache_misses;
+
+    /*
+     * Runs iterative deepening on a thread up to max_depth, until the search is stopped
+     * Helper threads (Lazy SMP, https://www.chessprogramming.org/Lazy_SMP) run the same loop, with every other one starting a ply deeper
+     * so that threads are spread over two depths. They mostly help the main thread by filling the shared transposition table
+    */
+    void iterative_deepening(SearchThread* thread, Color color, int max_depth);
 
-    // comparator used for sorting
-    static bool compare_possible_move(PossibleMove* pm, PossibleMove* pm2) {
-        return pm->score < pm2->score;
+    /*
+     * Recursive principal variation search (https://www.chessprogramming.org/Principal_Variation_Search) for color to move
+     * Scores are evaluations (see evaluate) for color at the leaves of the line, or mate scores. The stored hash move is searched first,
+     * and the rest are sorted by order_score if it does not cause a cutoff. A side in check is always searched at least one more ply
+    */
+    int search(SearchThread& thread, Color color, int depth, int alpha, int beta, int ply);
+    /*
+     * Quiescence search (https://www.chessprogramming.org/Quiescence_Search), run at the end of every search line so that it does not end in
+     * the middle of an exchange. Only captures and queen promotions are searched, and the side to move may always stop ("stand pat") with the
+     * evaluation of the position. Captures that could not raise alpha even with DELTA_MARGIN on top of the material won are skipped
+     * (delta pruning), and so are captures that lose material by static exchange evaluation (see Position::see). Captures are searched
+     * in MVV-LVA order
+    */
+    int quiescence(SearchThread& thread, Color color, int alpha, int beta, int ply);
+    /*
+     * Cheap move ordering score, computed without making the move: captures and queen promotions by MVV-LVA
+     * (https://www.chessprogramming.org/MVV-LVA), then the thread's killer moves at ply, then other moves by the thread's history score,
+     * and last the captures that lose material, again by MVV-LVA. losing_capture is the move's is_losing_capture result, which the
+     * caller computes once and keeps for the reduction
+    */
+    int order_score(SearchThread& thread, const BoardMove& m, int ply, bool losing_capture);
+    /*
+     * Returns how many plies less than usual a move is searched with (late move reductions). move_number is the index of the move in the
+     * search order at its node, quiet tells whether it neither captures nor promotes (see is_quiet), and losing_capture whether it is a
+     * capture losing material (see is_losing_capture). Losing captures are reduced by one ply. Other captures, promotions, killer moves
+     * and moves in or into check are never reduced
+    */
+    int reduction(SearchThread& thread, const BoardMove& m, bool quiet, bool losing_capture, int depth, int ply, int move_number,
+        bool in_check, bool gives_check);
+    // Returns true if the color index has pieces other than pawns and its king
+    static bool has_non_pawn_material(const Position& position, int color);
+    // Counts a cutoff by move, and remembers it as a killer and history move if it is quiet
+    void record_cutoff(SearchThread& thread, const BoardMove& m, int depth, int ply, bool first_move);
+    /*
+     * Hands the moves of the split point out as tasks on the thread's worker deque, and runs tasks (its own first, then stolen ones)
+     * until every task of the split point is finished
+    */
+    void split(SearchThread& thread, SplitPoint& sp);
+    // Searches the move of a task on a thread state and game of its own, unless the task was cancelled
+    void run_task(Task& task, int worker);
+    // Readies a thread handed out by an arena for a new search or task, except for its killer and history tables and its game
+    static void reset_thread(SearchThread& thread, int id);
+    // Sets up the thread's own game from the position and returns it. Reuses the game of an earlier search when there is one
+    static ChessGame* thread_game(SearchThread& thread, const Position& position);
+    // Takes the last task of the worker's deque if it belongs to the split point, or returns NULL
+    Task* pop_task(int worker, SplitPoint* sp);
+    // Takes the first task of another worker's deque, or returns NULL if there is none
+    Task* steal_task(int worker);
+    // Runs stolen tasks until the pool is stopped
+    void worker_loop(int worker);
+    // Returns true if the search was stopped, or if the thread is a task that was cancelled (directly or through the task that split)
+    bool aborted(const SearchThread& thread);
+    /*
+     * Looks up a position in the results of the thread's task, in those of the tasks it was split from and in the transposition table, and
+     * returns the deepest entry found, the most recent one among equally deep ones. A shallow result of a task's own zero window search
+     * would otherwise hide the hash move of the previous iteration
+     * Only the main thread writes to the transposition table, and never while tasks run, and the tasks a task was split from wait for it
+     * without storing anything, so every task finds the same entries whichever thread runs it and whenever it runs
+    */
+    bool probe_result(const SearchThread& thread, uint64_t key, TTEntry& entry);
+    /*
+     * Stores a search result in the transposition table, or in the results of the thread's task if it is searching one
+     * Once a split point is done, its owner stores the results of the tasks it takes there, in move order
+    */
+    void store_result(SearchThread& thread, uint64_t key, int depth, int bound, int score, uint16_t move);
+    // Makes move followed by the length moves of line, found from ply + 1, the thread's principal variation at ply
+    void update_pv(SearchThread& thread, int ply, uint16_t move, const uint16_t* line, int length);
+    // Expands pending promotions into one move per promotion piece, in place
+    static void expand_promotions(MoveList& moves);
+    // Milliseconds since the current generate_move call started
+    long long elapsed_ms();
+    // Counts a move made by the thread
+    void count_node(SearchThread& thread) {
+        thread.nodes.store(thread.nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (parallel_search == YOUNG_BROTHERS_WAIT) parallel_nodes.fetch_add(1, std::memory_order_relaxed);
     }
+    /*
+     * Returns true once the search should stop. On the main thread, the limits are checked as well (the clock only every few hundred nodes)
+    */
+    bool out_of_budget(SearchThread& thread);
+    // Plays a move found by search (including its promotion) on the game
+    void make_search_move(const BoardMove& m, ChessGame* game);
+    // Converts a line of packed moves into Moves, by playing the line on the game and undoing it afterwards
+    void build_principal_variation(Color color, ChessGame* game, const vector<uint16_t>& line);
+
+    // Returns the key of the game position with the given color to move. The game turn is not changed while searching, so it is not part of the game key
+    uint64_t position_key(Color color, ChessGame* game);
+    // Mate scores are stored in the transposition table relative to the node, so that they stay correct wherever the node is found again
+    static int score_to_tt(int score, int ply);
+    static int score_from_tt(int score, int ply);
+    /*
+     * Static evaluation of the thread's game for color (see the public evaluate). Looked up in the evaluation cache first, and otherwise
+     * computed from the accumulators of the game position when a network is loaded, or with the pawn structure from the thread's pawn
+     * hash table when not, and stored
+    */
+    int evaluate(SearchThread& thread, Color color);
+    // Tapers the material, piece-square and pawn structure scores (WHITE's minus BLACK's) of the position for color
+    static int evaluate(Color color, const Position& position, const int pawn_scores[Evaluation::NUM_PHASES]);
+    // Returns the piece index a move captures on the position it is made on, or NO_PIECE
+    static int captured_piece(const Position& position, const BoardMove& m);
+    // Returns true if a move neither captures nor promotes
+    static bool is_quiet(const Position& position, const BoardMove& m);
+    // Returns true if a move captures and loses material by static exchange evaluation (see Position::see)
+    static bool is_losing_capture(const Position& position, const BoardMove& m);
 
 public:
     ChessEngine();
     ChessEngine(int level);
+    ChessEngine(int level, int hash_size_mb);
+    // Creates an engine searching with the given parallel search when it has more than one thread (LAZY_SMP by default)
+    ChessEngine(int level, int hash_size_mb, ParallelSearch parallel_search);
+    ~ChessEngine();
 
     /*
      * Randomnly generates the next (valid) move for the given color (or current turn color if none is given)
@@ -72,34 +427,116 @@ public:
      * Utilizes the chess engine level. If level is low, the function takes less time to complete, but may result in worse moves,
      * while higher levels take more time to calculate and may result in better moves
      * 
-     * This function implements negamax with alpha-beta pruning. Note that one should check if in checkmate before generating move, as
-     * the function will result in error if it's already in checkmate
+     * This function implements principal variation search (negamax with alpha-beta pruning) with a transposition table. Note that one should
+     * check if in checkmate before generating move, as the function will result in error if it's already in checkmate
     */
     Move generate_move(Color color, ChessGame* game);
+    /*
+     * Same as generate_move, but with the given search limits instead of the engine's (see SearchLimits)
+    */
+    Move generate_move(Color color, ChessGame* game, SearchLimits search_limits);
+
+    /*
+     * Returns the line of best play found by the last generate_move call, starting with the generated move
+     * Moves after the first refer to pieces as they would be after the preceding moves. Pieces created by promotions in the line are reused by
+     * the game later, so they are only meaningful until the game changes
+    */
+    vector<Move> get_principal_variation();
+    /*
+     * Returns the share of cutoffs in the last generate_move call that were caused by the first move searched at a node (between 0 and 1),
+     * as a measure of move ordering quality. Quiescence search is not counted
+    */
+    double get_first_move_cutoff_rate();
+    // Returns how many static evaluations of the last generate_move call were found in the evaluation cache, and how many had to be computed
+    long long get_eval_cache_hits();
+    long long get_eval_cache_misses();
+    // Returns the share of pawn structure evaluations in the last generate_move call that were found in a pawn hash table (between 0 and 1)
+    double get_pawn_hash_hit_rate();
+
+    /*
+     * Static evaluation of the game for color: material, piece-square values, pawn structure (see Evaluation::evaluate_pawns), mobility and
+     * king safety (see Evaluation::evaluate_pieces) of color's pieces minus the opponent's, tapered between middlegame and endgame by game phase.
+     * Material and piece-square values are kept up to date by the position on every move. The search looks the pawn structure up in pawn hash tables, while this evaluates it every time
+     * When a network is loaded (see load_network), it evaluates the game instead
+    */
+    int evaluate(Color color, ChessGame* game);
+
+    /*
+     * Loads an NNUE network from a file (see Nnue.h for the format) to evaluate positions with instead of the hand-written evaluation.
+     * Returns false, keeping the current evaluation, if the file cannot be loaded. The evaluation cache is cleared, since its scores come
+     * from the previous evaluation
+     *
+     * While searching, the network's accumulators are kept up to date by the game position as moves are made and unmade, so the game
+     * being searched must not be changed from elsewhere until generate_move returns
+    */
+    bool load_network(const string& path);
+    // Goes back to the hand-written evaluation
+    void unload_network();
+    bool has_network();
 
     /*
      * Calculates utility (score) for a given move based several factors
      * - material value of captured (if any) piece
-     * - mobility value (how many moves it can take afterwards)
+     * - mobility value (how many more squares the moved piece attacks afterwards)
      * - center value (how close it is to the center)
      * - position value (how good is it's position according to the piece)
      * - check/mates
      * - pawn promotions
+     * The search scores positions with evaluate instead, since this makes and undoes the move
     */
     int calculate_utility(Move m, ChessGame* game);
 
     /*
-     * Tries to determine whether the current game is close to the end by checking the difference between the total piece values between
-     * the two colors, as well as the total number of pieces on each side
+     * Returns true once the game is closer to the endgame than to the middlegame, i.e. once at least half of the non-pawn material
+     * (weighted by the game phase, see Evaluation.h) has left the board. Evaluation does not switch on this, it tapers by game phase instead
     */
     bool is_end_game(ChessGame* game);
 
-    // Set chess engine level
+    /*
+     * Sets the limits used by generate_move when none are given. By default there are none, so the search goes to the engine level
+    */
+    void set_limits(SearchLimits new_limits);
+    SearchLimits get_limits();
+    // Returns the depth of the deepest search completed by the last move generation
+    int get_depth_reached();
+
+    /*
+     * Sets the enabled selective search techniques, as a bitmask of SearchFeatures (ALL_SEARCH_FEATURES by default), e.g. for A/B testing
+     * Disabling all of them gives a full width search, which finds the same move with more moves considered
+    */
+    void set_search_features(int features);
+    int get_search_features();
+
+    /*
+     * Sets the number of threads searching in generate_move (default 1). How extra threads search is chosen when the engine is created
+     * (see ParallelSearch). With LAZY_SMP, the moves considered count the moves of all threads. With YOUNG_BROTHERS_WAIT, they only
+     * count the moves of tasks that were not cancelled, and are the same for any number of threads
+     * WebAssembly builds always search with a single thread
+    */
+    void set_threads(int new_threads);
+    int get_threads();
+    ParallelSearch get_parallel_search();
+
+    // Set chess engine level. The level is the maximum search depth
     void set_level(int new_level);
     // Returns current chess engine level
     int get_level();
     // Gets the number of moves considered from the last move generation
     int get_moves_considered();
+
+    /*
+     * Sets the transposition table size in megabytes (default DEFAULT_TT_SIZE_MB). This clears the table
+    */
+    void set_hash_size(int size_mb);
+    int get_hash_size();
+    // Clears all stored search results, e.g. when starting a new, unrelated game
+    void clear_hash();
+    /*
+     * Sets the evaluation cache size in megabytes (default DEFAULT_EVAL_CACHE_SIZE_MB), independently of the transposition table. This clears
+     * the cache, and 0 disables it. Evaluations do not depend on the game they come from, so the cache is never cleared otherwise
+    */
+    void set_eval_cache_size(int size_mb);
+    int get_eval_cache_size();
 };
 
 #endif
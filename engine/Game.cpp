@@ -1,13 +1,32 @@
 #include "Game.h"
 
-bool ChessGame::will_check(Move m, Color color) {
-    if (board->within_boundaries(m.move_from) && board->within_boundaries(m.move_to)) {
-        move_valid(m);
-        bool in_check = is_check(color);
-        undo_move();
-        return in_check;
+BoardMove ChessGame::to_board_move(Move m) {
+    int flag = NORMAL_MOVE;
+    if (m.type == CASTLE || m.type == QUEENSIDE_CASTLE) flag = CASTLE_MOVE;
+    else if (m.type == PAWN_PROMOTION) flag = PROMOTION_MOVE;
+    else if (m.type == EN_PASSANT) flag = EN_PASSANT_MOVE;
+    return BoardMove(make_square(m.move_from.x, m.move_from.y), make_square(m.move_to.x, m.move_to.y), flag);
+}
+
+Move ChessGame::to_move(BoardMove m) {
+    Vector from = Vector(square_x(m.from()), square_y(m.from()));
+    Vector to = Vector(square_x(m.to()), square_y(m.to()));
+    Piece* moved = board->get_piece(from);
+    switch (m.flag()) {
+        case CASTLE_MOVE: return Move(from, to, moved, NULL, to.x == 6 ? CASTLE : QUEENSIDE_CASTLE);
+        case PROMOTION_MOVE: return Move(from, to, moved, board->get_piece(to), PAWN_PROMOTION);
+        case EN_PASSANT_MOVE: return Move(from, to, moved, board->get_piece(to.x, from.y), EN_PASSANT);
+        default: return Move(from, to, moved, board->get_piece(to));
     }
-    return false;
+}
+
+vector<Move> ChessGame::to_moves(const MoveList& moves) {
+    vector<Move> converted;
+    converted.reserve(moves.size());
+    for (auto m = moves.begin(); m != moves.end(); m++) {
+        converted.push_back(to_move(*m));
+    }
+    return converted;
 }
 
 vector<Move> ChessGame::get_moves(Vector v) { return get_moves(board->get_piece(v)); }
@@ -15,109 +34,85 @@ vector<Move> ChessGame::get_moves(int x, int y) { return get_moves(board->get_pi
 vector<Move> ChessGame::get_moves(Piece* piece) {
     vector<Move> moves;
     if (piece != NULL) {
-        vector<Vector> moveset = piece->get_moveset();
-        int moveset_size = moveset.size();
+        Position& position = board->get_position();
         Color color = piece->color;
+        int ci = color_index(color);
         PieceType type = piece->type;
-        Vector position = piece->position;
+        Vector position_vec = piece->position;
+        int from = make_square(position_vec.x, position_vec.y);
+        Bitboard occupied = position.get_occupied();
+        Bitboard targets = EMPTY_BB;
 
-        if (type == KNIGHT) {
-            for (int i = 0; i < moveset_size; i++) {
-                Vector v = position.add(moveset.at(i));
-                Piece* p = board->get_piece(v);
-                if (board->within_boundaries(v) && (p == NULL || p->color != color)) {
-                    moves.push_back(Move(position, v, piece, p));
-                }
-            }
-        } else if (type == BISHOP || type == ROOK || type == QUEEN) {
-            for (int i = 0; i < moveset_size; i++) {
-                for (int j = 1; j < BOARD_SIZE; j++) {
-                    Vector v = position.add(moveset.at(i).scale(j));
-                    Piece* p = board->get_piece(v);
-                    if (!board->within_boundaries(v) || (p != NULL && p->color == color)) {
-                        break;
-                    } else {
-                        moves.push_back(Move(position, v, piece, p));
-                        if (p != NULL) break;
-                    }
-                }
-            }
-        } else if (type == PAWN) {
+        if (type == PAWN) {
             int sign = color == WHITE ? 1 : -1;
             // check capture moves
-            for (int i = 2; i < 4; i++) {
-                Vector v = position.add(moveset.at(i).scale(sign));
-                if (board->within_boundaries(v)) {
-                    Piece* p = board->get_piece(v);
-                    if (p != NULL && p->color != color) {
-                        moves.push_back(Move(position, v, piece, p, v.y == 7 || v.y == 0 ? PAWN_PROMOTION : CAPTURE));
-                    }
-                }
+            Bitboard captures = pawn_attacks(ci, from) & position.get_occupancy(ci ^ 1);
+            while (captures) {
+                int to = pop_lsb(captures);
+                Vector v = Vector(square_x(to), square_y(to));
+                moves.push_back(Move(position_vec, v, piece, board->get_piece(v), v.y == 7 || v.y == 0 ? PAWN_PROMOTION : CAPTURE));
             }
-            // check move forward 1
-            Vector forward1 = position.add(moveset.at(0).scale(sign));
-            if (board->within_boundaries(forward1) && board->get_piece(forward1) == NULL) {
-                moves.push_back(Move(position, forward1, piece, NULL, forward1.y == 7 || forward1.y == 0 ? PAWN_PROMOTION : MOVE));
-            }
-            // check move forward 2
-            Vector forward2 = Vector(position.x, color == WHITE ? 3 : 4);
-            if (
-                ((color == WHITE && position.y == 1) || (color == BLACK && position.y == 6))
-                && (board->get_piece(forward1) == NULL)
-                && (board->get_piece(forward2) == NULL)
-            ) {
-                moves.push_back(Move(position, forward2, piece, NULL));
+            int en_passant = position.get_en_passant_square();
+            if (en_passant != NO_SQUARE && square_y(en_passant) == (color == WHITE ? 5 : 2) && (pawn_attacks(ci, from) & square_bb(en_passant))) {
+                Vector v = Vector(square_x(en_passant), square_y(en_passant));
+                moves.push_back(Move(position_vec, v, piece, board->get_piece(v.x, position_vec.y), EN_PASSANT));
             }
-        } else if (type == KING) {
-            for (int i = 0; i < moveset_size; i++) {
-                Vector v = position.add(moveset.at(i));
-                Piece* p = board->get_piece(v);
-                if (board->within_boundaries(v) && (p == NULL || p->color != color)) {
-                    moves.push_back(Move(position, v, piece, p));
+            // check move forward 1
+            Vector forward1 = Vector(position_vec.x, position_vec.y + sign);
+            if (board->within_boundaries(forward1) && position.is_empty(make_square(forward1.x, forward1.y))) {
+                moves.push_back(Move(position_vec, forward1, piece, NULL, forward1.y == 7 || forward1.y == 0 ? PAWN_PROMOTION : MOVE));
+                // check move forward 2
+                Vector forward2 = Vector(position_vec.x, color == WHITE ? 3 : 4);
+                if (
+                    ((color == WHITE && position_vec.y == 1) || (color == BLACK && position_vec.y == 6))
+                    && position.is_empty(make_square(forward2.x, forward2.y))
+                ) {
+                    moves.push_back(Move(position_vec, forward2, piece, NULL));
                 }
             }
+            return moves;
+        }
 
-            // castling
-            if (!piece->has_moved) {
-                int row = color == WHITE ? 0 : 7;
-                for (int x = 0; x <= 7; x += 7) {
-                    Piece* rook = board->get_piece(x, row);
-                    if (rook != NULL && !rook->has_moved) {
-                        bool bad = false;
-                        int step = x == 7 ? 1 : -1;
-                        for (int i = position.x + step; i != x; i += step) {
-                            // make sure there are no pieces between
-                            if (board->get_piece(i, row) != NULL) {
-                                bad = true;
-                                break;
-                            }
-                        }
-                        if (!bad) {
-                            for (int i = position.x + step; i != x; i += step) {
-                                // make sure there are no spaces are interfered with an enemy piece
-                                // do a separate loop because calling will_check() can be expensive
-                                if (will_check(Move(position, Vector(i, row), piece, NULL), color)) {
-                                    bad = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (!bad) {
-                            moves.push_back(Move(position, Vector(x == 0 ? 2 : 6, row), piece, NULL, x == 0 ? QUEENSIDE_CASTLE : CASTLE));
-                        }
-                    }
-                }
+        switch (type) {
+            case KNIGHT: targets = knight_attacks(from); break;
+            case BISHOP: targets = bishop_attacks(from, occupied); break;
+            case ROOK: targets = rook_attacks(from, occupied); break;
+            case QUEEN: targets = queen_attacks(from, occupied); break;
+            case KING: targets = king_attacks(from); break;
+            default: break;
+        }
+        targets &= ~position.get_occupancy(ci);
+        while (targets) {
+            int to = pop_lsb(targets);
+            Vector v = Vector(square_x(to), square_y(to));
+            moves.push_back(Move(position_vec, v, piece, board->get_piece(v)));
+        }
+
+        // castling, which the legal move generator already checks for attacked squares
+        if (type == KING && position.piece_on(from) == Position::make_piece(ci, KING_INDEX)) {
+            MoveList king_moves;
+            generate_legal_moves(position, ci, king_moves, square_bb(from));
+            for (auto m = king_moves.begin(); m != king_moves.end(); m++) {
+                if (m->flag() == CASTLE_MOVE) moves.push_back(to_move(*m));
             }
         }
     }
     return moves;
 }
 
-ChessGame::ChessGame() : turn(WHITE), pieces_to_promote({}), board(new Board()) {}
+ChessGame::ChessGame() : board(new Board()) {}
+ChessGame::ChessGame(const Position& position) : board(new Board(position)) {}
+
+void ChessGame::set_position(const Position& position) {
+    move_history.clear();
+    board->set_position(position);
+}
 
 bool ChessGame::move_piece(int fx, int fy, int tx, int ty) { return move_piece(Vector(fx, fy), Vector(tx, ty)); }
 bool ChessGame::move_piece(Vector from, Vector to) { return move_piece(Move(from, to, board->get_piece(from), board->get_piece(to))); }
 bool ChessGame::move_piece(Move m) {
+    // counted on the position, whose undo stack also holds the moves of the position a game was created from
+    if (board->get_position().history_size() >= MAX_GAME_MOVES) return false;
     if (is_valid_move(m)) {
         // correctly update move type
         if (m.piece_replaced != NULL) m.type = CAPTURE;
@@ -130,6 +125,9 @@ bool ChessGame::move_piece(Move m) {
         }
         if (m.piece_moved->type == PAWN && (m.move_to.y == 0 || m.move_to.y == 7)) {
             m.type = PAWN_PROMOTION;
+        } else if (m.piece_moved->type == PAWN && m.move_from.x != m.move_to.x && m.piece_replaced == NULL) {
+            // pawn moving diagonally onto an empty square
+            m.type = EN_PASSANT;
         }
         move_valid(m);
         return true;
@@ -138,107 +136,38 @@ bool ChessGame::move_piece(Move m) {
 }
 
 void ChessGame::move_valid(Move m) {
-    board->replace_piece(m.move_to, m.piece_moved);
-    board->clear_piece(m.move_from);
-    if (m.type == CASTLE || m.type == QUEENSIDE_CASTLE) {
-        Vector rook_pos = Vector(m.move_to.x == 6 ? 7 : 0, m.move_from.y);
-        Piece* rook = board->get_piece(rook_pos);
-        board->replace_piece(rook_pos.x == 7 ? 5 : 3, rook_pos.y, rook);
-        board->clear_piece(rook_pos);
+    Position& position = board->get_position();
+    // moving a piece does not change the turn, that is left to next_turn()
+    Color turn = position.get_side();
+    position.make_move(to_board_move(m));
+    position.set_side(turn);
+
+    // mirror the move on the Piece* view
+    Piece* replaced = board->move_view(make_square(m.move_from.x, m.move_from.y), make_square(m.move_to.x, m.move_to.y));
+    if (m.type == EN_PASSANT) {
+        replaced = board->set_view(make_square(m.move_to.x, m.move_from.y), NULL);
+    } else if (m.type == CASTLE || m.type == QUEENSIDE_CASTLE) {
+        int row = m.move_from.y;
+        int rook_x = m.move_to.x == 6 ? 7 : 0;
+        Piece* rook = board->get_piece(rook_x, row);
+        board->move_view(make_square(rook_x, row), make_square(rook_x == 7 ? 5 : 3, row));
         rook->has_moved = true;
     }
-    Move* to_store = new Move(m.move_from, m.move_to, m.piece_moved, m.piece_replaced, m.type);
-    if (m.type == PAWN_PROMOTION) {
-        pieces_to_promote.insert(pair<string, Move*>(m.piece_moved->get_id(), to_store));
-    }
-    move_history.push_back(to_store);
+    move_history.push_back(Move(m.move_from, m.move_to, m.piece_moved, replaced, m.type));
     m.piece_moved->has_moved = true;
 }
 
-bool ChessGame::is_valid_move(Move m) { return is_valid_move(m, turn); }
+bool ChessGame::is_valid_move(Move m) { return is_valid_move(m, get_turn()); }
 bool ChessGame::is_valid_move(Move m, Color color) {
     if (
         board->within_boundaries(m.move_from) && board->within_boundaries(m.move_to) &&
         m.piece_moved != NULL && m.piece_moved->color == color && m.move_from.equal_to(m.piece_moved->position)
     ) {
-        PieceType type = m.piece_moved->type;
-        vector<Vector> moveset = m.piece_moved->get_moveset();
-        int moveset_size = moveset.size();
-        Vector position = m.move_from;
-        Vector next_position = m.move_to;
-
-        if (type == KNIGHT) {
-            for (int i = 0; i < moveset_size; i++) {
-                Vector v = position.add(moveset.at(i));
-                Piece* p = board->get_piece(v);
-                if (m.move_to.equal_to(v) && (p == NULL || p->color != color)) {
-                    return !will_check(m, color);
-                }
-            }
-        } else if (type == BISHOP || type == ROOK || type == QUEEN) {
-            for (int i = 0; i < moveset_size; i++) {
-                for (int j = 1; j < BOARD_SIZE; j++) {
-                    Vector v = position.add(moveset.at(i).scale(j));
-                    Piece* p = board->get_piece(v);
-                    if (!board->within_boundaries(v) || (p != NULL && (!next_position.equal_to(v) || p->color == color))) {
-                        break;
-                    } else if (next_position.equal_to(v) && (p == NULL || (p != NULL && p->color != color))) {
-                        return !will_check(m, color);
-                    }
-                }
-            }
-        } else if (type == PAWN) {
-            int sign = color == WHITE ? 1 : -1;
-            // check capture moves
-            for (int i = 2; i < 4; i++) {
-                Vector v = position.add(moveset.at(i).scale(sign));
-                Piece* p = board->get_piece(v);
-                if (next_position.equal_to(v) && p != NULL && p->color != color) {
-                    return !will_check(m, color);
-                }
-            }
-            return (
-                // check move forward 1
-                (next_position.equal_to(position.add(moveset.at(0).scale(sign))))
-                && (board->get_piece(next_position) == NULL)
-                && !will_check(m, color)
-            ) || (
-                // check move forward 2
-                (next_position.equal_to(position.add(moveset.at(1).scale(sign))))
-                && ((color == WHITE && position.y == 1) || (color == BLACK && position.y == 6))
-                && (board->get_piece(position.x, color == WHITE ? 2 : 5) == NULL)
-                && (board->get_piece(position.x, color == WHITE ? 3 : 4) == NULL)
-                && !will_check(m, color)
-            );
-        } else if (type == KING) {
-            for (int i = 0; i < moveset_size; i++) {
-                Vector v = position.add(moveset.at(i));
-                Piece* p = board->get_piece(v);
-                if (m.move_to.equal_to(v) && (p == NULL || p->color != color)) {
-                    return !will_check(m, color);
-                }
-            }
-            // castling
-            int row = color == WHITE ? 0 : 7;
-            int next_x = next_position.x;
-            if (!m.piece_moved->has_moved && (next_x == 6 || next_x == 2)) {
-                int rook_x = next_x == 6 ? 7 : 0;
-                Piece* rook = board->get_piece(rook_x, row);
-                // if it hasn't moved, then it's guaranteed to be a rook
-                if (rook != NULL && !rook->has_moved && !is_check(color)) {
-                    int step = rook_x == 7 ? 1 : -1;
-                    // make sure there are no pieces between
-                    for (int i = position.x + step; i != rook_x; i += step) {
-                        if (board->get_piece(i, row) != NULL) return false;
-                    }
-                    // make sure there are no spaces are interfered with an enemy piece
-                    // in a separate loop because will_check can be expensive
-                    for (int i = position.x + step; i != rook_x; i += step) {
-                        if (will_check(Move(position, Vector(i, row), m.piece_moved, NULL), color)) return false;
-                    }
-                    return true;
-                } else return false;
-            } else return false;
+        MoveList valid_moves;
+        get_valid_moves(m.move_from.x, m.move_from.y, valid_moves);
+        int to = make_square(m.move_to.x, m.move_to.y);
+        for (auto vm = valid_moves.begin(); vm != valid_moves.end(); vm++) {
+            if (vm->to() == to) return true;
         }
     }
     return false;
@@ -246,248 +175,126 @@ bool ChessGame::is_valid_move(Move m, Color color) {
 
 vector<Move> ChessGame::get_valid_moves(Vector v) { return get_valid_moves(v.x, v.y); }
 vector<Move> ChessGame::get_valid_moves(int x, int y) {
+    MoveList valid_moves;
+    get_valid_moves(x, y, valid_moves);
+    return to_moves(valid_moves);
+}
+void ChessGame::get_valid_moves(int x, int y, MoveList& moves) {
     Piece* piece = board->get_piece(x, y);
-    vector<Move> valid_moves;
     if (piece != NULL) {
-        vector<Vector> moveset = piece->get_moveset();
-        int moveset_size = moveset.size();
-        Color color = piece->color;
-        PieceType type = piece->type;
-        Vector position = piece->position;
-
-        if (type == KNIGHT) {
-            for (int i = 0; i < moveset_size; i++) {
-                Vector v = position.add(moveset.at(i));
-                Piece* p = board->get_piece(v);
-                if (board->within_boundaries(v) && (p == NULL || p->color != color)) {
-                    Move m = Move(position, v, piece, p);
-                    if (!will_check(m, color)) {
-                        valid_moves.push_back(m);
-                    }
-                }
-            }
-        } else if (type == BISHOP || type == ROOK || type == QUEEN) {
-            for (int i = 0; i < moveset_size; i++) {
-                for (int j = 1; j < BOARD_SIZE; j++) {
-                    Vector v = position.add(moveset.at(i).scale(j));
-                    Piece* p = board->get_piece(v);
-                    if (!board->within_boundaries(v) || (p != NULL && p->color == color)) {
-                        break;
-                    } else {
-                        Move m = Move(position, v, piece, p);
-                        if (!will_check(m, color)) valid_moves.push_back(m);
-                        if (p != NULL) break;
-                    }
-                }
-            }
-        } else if (type == PAWN) {
-            int sign = color == WHITE ? 1 : -1;
-            // check capture moves
-            for (int i = 2; i < 4; i++) {
-                Vector v = position.add(moveset.at(i).scale(sign));
-                if (board->within_boundaries(v)) {
-                    Piece* p = board->get_piece(v);
-                    if (p != NULL && p->color != color) {
-                        Move m = Move(position, v, piece, p, v.y == 7 || v.y == 0 ? PAWN_PROMOTION : CAPTURE);
-                        if (!will_check(m, color)) valid_moves.push_back(m);
-                    }
-                }
-            }
-            // check move forward 1
-            Vector forward1 = position.add(moveset.at(0).scale(sign));
-            Move forward1_move = Move(position, forward1, piece, NULL, forward1.y == 7 || forward1.y == 0 ? PAWN_PROMOTION : MOVE);
-            if (board->within_boundaries(forward1) && board->get_piece(forward1) == NULL && !will_check(forward1_move, color)) {
-                valid_moves.push_back(forward1_move);
-            }
-            // check move forward 2
-            Vector forward2 = Vector(position.x, color == WHITE ? 3 : 4);
-            Move forward2_move = Move(position, forward2, piece, NULL);
-            if (
-                ((color == WHITE && position.y == 1) || (color == BLACK && position.y == 6))
-                && (board->get_piece(forward1) == NULL)
-                && (board->get_piece(forward2) == NULL)
-                && !will_check(forward2_move, color)
-            ) {
-                valid_moves.push_back(forward2_move);
-            }
-        } else if (type == KING) {
-            for (int i = 0; i < moveset_size; i++) {
-                Vector v = position.add(moveset.at(i));
-                Piece* p = board->get_piece(v);
-                if (board->within_boundaries(v) && (p == NULL || p->color != color)) {
-                    Move m = Move(position, v, piece, p);
-                    if (!will_check(m, color)) {
-                        valid_moves.push_back(m);
-                    }
-                }
-            }
-
-            // castling
-            if (!piece->has_moved) {
-                int row = color == WHITE ? 0 : 7;
-                for (int x = 0; x <= 7; x += 7) {
-                    Piece* rook = board->get_piece(x, row);
-                    if (rook != NULL && !rook->has_moved && !is_check(color)) {
-                        bool bad = false;
-                        int step = x == 7 ? 1 : -1;
-                        for (int i = position.x + step; i != x; i += step) {
-                            Vector v = Vector(i, row);
-                            Move m = Move(position, v, piece, NULL);
-                            // make sure there are no pieces between
-                            if (board->get_piece(v) != NULL || will_check(m, color)) {
-                                bad = true;
-                                break;
-                            }
-                        }
-                        if (!bad) {
-                            // now check if there are spaces where enemy pieces interfere
-                            // we do a separate loop because calling will_check is a bit expensive
-                            for (int i = position.x + step; i != x; i+= step) {
-                                Vector v = Vector(i, row);
-                                Move m = Move(position, v, piece, NULL);
-                                if (will_check(m, color)) {
-                                    bad = true;
-                                    break;
-                                }
-                            }
-                        }
-                        if (!bad) {
-                            valid_moves.push_back(Move(position, Vector(x == 0 ? 2 : 6, row), piece, NULL, x == 0 ? QUEENSIDE_CASTLE : CASTLE));
-                        }
-                    }
-                }
-            }
-        }
+        generate_legal_moves(board->get_position(), color_index(piece->color), moves, square_bb(make_square(x, y)));
     }
-    return valid_moves;
 }
 
-vector<Move> ChessGame::get_all_valid_moves() { return get_all_valid_moves(turn); }
+vector<Move> ChessGame::get_all_valid_moves() { return get_all_valid_moves(get_turn()); }
 vector<Move> ChessGame::get_all_valid_moves(Color color) {
-    vector<Move> valid_moves;
-    vector<Piece*> pieces = board->get_pieces(color);
-    for (auto pa = pieces.begin(); pa != pieces.end(); pa++) {
-        vector<Move> moves = get_valid_moves((*pa)->position);
-        for (auto m = moves.begin(); m != moves.end(); m++) {
-            valid_moves.push_back(*m);
-        }
-    }
-    return valid_moves;
+    MoveList valid_moves;
+    get_all_valid_moves(color, valid_moves);
+    return to_moves(valid_moves);
+}
+void ChessGame::get_all_valid_moves(Color color, MoveList& moves) {
+    generate_legal_moves(board->get_position(), color_index(color), moves);
 }
 
-bool ChessGame::is_check() { return is_check(turn); }
+bool ChessGame::is_check() { return is_check(get_turn()); }
 bool ChessGame::is_check(Color color) {
-    Vector king_position = board->get_king(color)->position;
-    vector<Piece*> pieces = board->get_pieces(get_other_color(color));
-    // TODO: maybe consider sorting moves beforehand?
-    for (auto pa = pieces.begin(); pa != pieces.end(); pa++) {
-        vector<Move> valid_moves = get_moves(*pa);
-        for (auto m = valid_moves.begin(); m != valid_moves.end(); m++) {
-            if (m->type == CASTLE || m->type == QUEENSIDE_CASTLE) continue;
-            if (m->move_to.equal_to(king_position)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return board->get_position().in_check(color_index(color));
 }
 
-bool ChessGame::is_checkmate() { return is_checkmate(turn); }
+bool ChessGame::is_checkmate() { return is_checkmate(get_turn()); }
 bool ChessGame::is_checkmate(Color color) {
-    if (is_check(color)) {
-        // check if we have a piece that can prevent check, i.e. at least one valid move
-        // this is faster than finding all possible moves first, since here we could return right away
-        vector<Piece*> pieces = board->get_pieces(color);
-        for (auto pa = pieces.begin(); pa != pieces.end(); pa++) {
-            vector<Move> valid_moves = get_moves(*pa);
-            for (auto m = valid_moves.begin(); m != valid_moves.end(); m++) {
-                if (m->type == CASTLE || m->type == QUEENSIDE_CASTLE) continue;
-                if (!will_check(*m, color)) {
-                    return false;
-                }
-            }
-        }
-        return true;
-    }
-    return false;
+    // check if we have a piece that can prevent check, i.e. at least one valid move
+    return is_check(color) && !has_legal_moves(board->get_position(), color_index(color));
 }
 
-bool ChessGame::is_stalemate() { return is_stalemate(turn); }
+bool ChessGame::is_stalemate() { return is_stalemate(get_turn()); }
 bool ChessGame::is_stalemate(Color color) {
     // exact same logic is checkmate, except we're not in check
-    if (!is_check(color)) {
-        vector<Piece*> pieces = board->get_pieces(color);
-        for (auto pa = pieces.begin(); pa != pieces.end(); pa++) {
-            vector<Move> valid_moves = get_moves(*pa);
-            // if we have at least one valid move, then we're not in stalemate
-            for (auto m = valid_moves.begin(); m != valid_moves.end(); m++) {
-                if (!will_check(*m, color)) {
-                    return false;
-                }
-            }
-        }
-        return true;
+    return !is_check(color) && !has_legal_moves(board->get_position(), color_index(color));
+}
+
+Move* ChessGame::pending_promotion(int square) {
+    // usually the last move, unless other moves were made before completing the promotion
+    for (int i = move_history.size() - 1; i >= 0; i--) {
+        Move& m = move_history[i];
+        if (m.type == PAWN_PROMOTION && m.promote_to == NONE && make_square(m.move_to.x, m.move_to.y) == square) return &m;
     }
-    return false;
+    return NULL;
 }
 
-bool ChessGame::pawn_promotion_available(int x, int y) { return pawn_promotion_available(board->get_piece(x, y)->get_id()); }
-bool ChessGame::pawn_promotion_available(Vector v) { return pawn_promotion_available(board->get_piece(v)->get_id()); }
+bool ChessGame::pawn_promotion_available(Vector v) { return pawn_promotion_available(v.x, v.y); }
 bool ChessGame::pawn_promotion_available(string piece_id) {
-    return pieces_to_promote.find(piece_id) != pieces_to_promote.end();
+    Piece* piece = board->get_piece(piece_id);
+    return piece != NULL && pawn_promotion_available(piece->position);
+}
+bool ChessGame::pawn_promotion_available(int x, int y) {
+    // a pawn waiting for promotion is the only kind of pawn that can stand on the last rank
+    Piece* piece = board->get_piece(x, y);
+    return piece != NULL && piece->type == PAWN && (y == 0 || y == 7);
 }
 
-bool ChessGame::promote_pawn(int x, int y, PieceType promo_to) { return promote_pawn(board->get_piece(x, y)->get_id(), promo_to); }
-bool ChessGame::promote_pawn(Vector v, PieceType promo_to) { return promote_pawn(board->get_piece(v)->get_id(), promo_to); }
-bool ChessGame::promote_pawn(string piece_id, PieceType promote_to) {
-    auto pf = pieces_to_promote.find(piece_id);
-    if (pf != pieces_to_promote.end()) {
-        Move* m = pf->second;
-        Piece* pawn = m->piece_moved;
-        Color color = pawn->color;
-        Vector pos = pawn->position;
-        Piece* new_piece;
-        switch (promote_to) {
-            case KNIGHT: new_piece = new Knight(color, pos); break;
-            case BISHOP: new_piece = new Bishop(color, pos); break;
-            case ROOK: new_piece = new Rook(color, pos); break;
-            case QUEEN: new_piece = new Queen(color, pos); break;
-            default: return false;
-        }
-        new_piece->has_moved = true;
+bool ChessGame::promote_pawn(Vector v, PieceType promo_to) { return promote_pawn(v.x, v.y, promo_to); }
+bool ChessGame::promote_pawn(string piece_id, PieceType promo_to) {
+    Piece* piece = board->get_piece(piece_id);
+    return piece != NULL && promote_pawn(piece->position, promo_to);
+}
+bool ChessGame::promote_pawn(int x, int y, PieceType promote_to) {
+    if (!pawn_promotion_available(x, y)) return false;
+    if (promote_to != KNIGHT && promote_to != BISHOP && promote_to != ROOK && promote_to != QUEEN) return false;
+    Piece* pawn = board->get_piece(x, y);
+    int square = make_square(x, y);
+    Piece* new_piece = board->create_piece(promote_to, pawn->color, pawn->position);
+    new_piece->has_moved = true;
+    board->get_position().promote(square, promote_to);
+    board->set_view(square, new_piece);
+    // the move that brought the pawn there remembers it, so that undoing the move brings back the pawn
+    Move* m = pending_promotion(square);
+    if (m != NULL) {
         m->piece_moved = new_piece;
-        m->old_pawn = board->replace_piece(pos, new_piece);
+        m->old_pawn = pawn;
         m->promote_to = promote_to;
-        pieces_to_promote.erase(piece_id);
-        return true;
     }
-    return false;
+    return true;
 }
 
 void ChessGame::undo_move() {
     if (move_history.empty()) return;
-    Move* m = move_history.back();
-    board->replace_piece(m->move_to, m->piece_replaced);
-    board->replace_piece(m->move_from, m->piece_moved);
+    Move* m = &move_history.back();
+    Position& position = board->get_position();
+    // undoing a move does not change the turn either
+    Color turn = position.get_side();
+    position.unmake_move();
+    position.set_side(turn);
+
+    int from = make_square(m->move_from.x, m->move_from.y);
+    int to = make_square(m->move_to.x, m->move_to.y);
+    if (m->type == EN_PASSANT) {
+        board->set_view(to, NULL);
+        board->set_view(make_square(m->move_to.x, m->move_from.y), m->piece_replaced);
+    } else {
+        board->set_view(to, m->piece_replaced);
+    }
+    board->set_view(from, m->type == PAWN_PROMOTION ? m->old_pawn : m->piece_moved);
     if (m->type == CASTLE || m->type == QUEENSIDE_CASTLE) {
-        Vector rook_pos = Vector(m->move_to.x == 6 ? 5 : 3, m->move_from.y);
-        Piece* rook = board->get_piece(rook_pos);
-        board->replace_piece(rook_pos.x == 5 ? 7 : 0, rook_pos.y, rook);
-        board->clear_piece(rook_pos);
+        int row = m->move_from.y;
+        int rook_x = m->move_to.x == 6 ? 5 : 3;
+        Piece* rook = board->get_piece(rook_x, row);
+        board->move_view(make_square(rook_x, row), make_square(rook_x == 5 ? 7 : 0, row));
         rook->has_moved = !m->first_move;
     }
-    if (m->type == PAWN_PROMOTION) {
-        board->replace_piece(m->move_from, m->old_pawn);
-        pieces_to_promote.erase(m->old_pawn->get_id());
+    if (m->type == PAWN_PROMOTION && m->promote_to != NONE) {
+        m->old_pawn->has_moved = !m->first_move;
+        // nothing refers to the promoted piece anymore
+        board->release_piece(m->piece_moved);
+    } else {
+        m->piece_moved->has_moved = !m->first_move;
     }
-    m->piece_moved->has_moved = !m->first_move;
-    delete m;
     move_history.pop_back();
 }
 
 Move* ChessGame::peek_history(int index) {
     if (index < 0 || index >= (int) move_history.size()) return NULL;
-    return move_history.at(index);
+    return &move_history[index];
 }
 
 Move* ChessGame::peek_history_back() { return peek_history(move_history.size() - 1); }
@@ -498,21 +305,22 @@ void ChessGame::reset_game() {
     // perhaps there's a better way to do this, but im lazy rn lol
     delete board;
     board = new Board();
-    turn = WHITE;
-    while (move_history.size()) {
-        delete move_history.back();
-        move_history.pop_back();
-    }
+    move_history.clear();
 }
 
-void ChessGame::next_turn() { turn = turn == WHITE ? BLACK : WHITE; }
-Color ChessGame::get_turn() { return turn; }
-void ChessGame::set_turn(Color color) { turn = color; }
+bool ChessGame::load_fen(const string& fen) {
+    move_history.clear();
+    delete board;
+    board = new Board(fen);
+    return board->get_position().get_occupied() != EMPTY_BB;
+}
+
+void ChessGame::next_turn() { set_turn(get_other_color(get_turn())); }
+Color ChessGame::get_turn() { return board->get_position().get_side(); }
+void ChessGame::set_turn(Color color) { board->get_position().set_side(color); }
+
+uint64_t ChessGame::get_key() { return board->get_position().get_key(); }
 
 ChessGame::~ChessGame() {
     delete board;
-    while (!move_history.empty()) {
-        delete move_history.back();
-        move_history.pop_back();
-    }
 }
@@ -2,29 +2,44 @@
 #define CHESS_GAME_H
 
 #include "Util/Move.h"
+#include "Util/FixedStack.h"
 #include "Board/Board.h"
+#include "Board/MoveGen.h"
 
 class ChessGame {
 private:
-    Color turn;
-    vector<Move*> move_history;
-
-    unordered_map<string, Move*> pieces_to_promote;
-
     /*
-     * Checks if a move will result in check
+     * Moves made on the game, oldest first. Plain values on a fixed capacity stack (see HISTORY_CAPACITY), so that making and undoing
+     * moves does not allocate. What else is needed to undo a move is kept on the position's own undo stack
     */
-    bool will_check(Move m, Color color);
+    FixedStack<Move, HISTORY_CAPACITY> move_history;
+
+    // Returns the move in history that brought the pawn now waiting for promotion on square there, or NULL
+    Move* pending_promotion(int square);
+
+    // Converts a list of legal moves from the bitboard position to Moves
+    vector<Move> to_moves(const MoveList& moves);
 
 public:
     Board* board;
     
     ChessGame();
+    /*
+     * Creates a game starting from a copy of the given position, without any move history
+     * Used to give every search thread a game of its own
+    */
+    ChessGame(const Position& position);
+    /*
+     * Sets up the game from a copy of the given position, clearing the move history. Unlike creating a new game, this reuses the pieces
+     * and memory of the game, so setting up the same game over and over (e.g. for search threads) does not allocate
+    */
+    void set_position(const Position& position);
 
     /*
      * Move piece from (fx, fy) to (tx, ty)
      * Returns true if it's a valid move, or false if the move is invalid or the move would result in a check for the current turn
      * If it's a valid move, it performs the move and adds to move history
+     * Also returns false once the game is MAX_GAME_MOVES moves long, leaving the rest of the history room to the engine's search
     */
     bool move_piece(int fx, int fy, int tx, int ty);
     bool move_piece(Vector from, Vector to);
@@ -40,13 +55,13 @@ public:
     /*
      * Assumes the move passed is valid (to avoid additional function calls/loops), performs move, and adds to move history
      * For general use, it is highly recommended to use move_piece instead. Only call this function if you are absolutely sure the move is valid.
+     * Aborts the program if the move history already holds HISTORY_CAPACITY moves
     */
     void move_valid(Move m);
 
     /*
-     * Gets all possible moves. NOTE: These include moves that may result in playing color to have check.
-     * This function is identical to get_all_valid_moves, without the call to will_check().
-     * We just have this function to avoid an infinite call between is_check() and get_valid_moves()
+     * Gets all possible (pseudo-legal) moves for a piece. NOTE: These include moves that may result in playing color to have check.
+     * Castling is only included when it is legal
     */
     vector<Move> get_moves(Vector v);
     vector<Move> get_moves(int x, int y);
@@ -57,12 +72,27 @@ public:
     */
     vector<Move> get_valid_moves(int x, int y);
     vector<Move> get_valid_moves(Vector v);
+    // Same as get_valid_moves, but appends the moves to a caller provided list without allocating. Promotions are left pending
+    void get_valid_moves(int x, int y, MoveList& moves);
 
     /*
      * Returns all possible (valid) moves for the current turn (or specified color)
     */
     vector<Move> get_all_valid_moves();
     vector<Move> get_all_valid_moves(Color color);
+    /*
+     * Same as get_all_valid_moves, but appends the moves to a caller provided list without allocating, which is what the engine
+     * searches with. Promotions are left pending, i.e. generated once with promote_to set to NONE
+    */
+    void get_all_valid_moves(Color color, MoveList& moves);
+
+    /*
+     * Conversions between the Move of the API and the packed BoardMove used internally (see Position.h)
+     * to_board_move always leaves promotions pending, to be completed with promote_pawn. to_move looks up the pieces on the current board,
+     * so it must be called before the move is made
+    */
+    BoardMove to_board_move(Move m);
+    Move to_move(BoardMove m);
 
     /*
      * Checks if the given color (or current turn color if none is given) is in check
@@ -83,7 +113,7 @@ public:
     bool is_stalemate(Color color);
 
     /*
-     * Check if a pawn at a given position (or given piece id) is available for promotion
+     * Check if a pawn at a given position (or given piece id) is available for promotion, i.e. it stands on the last rank
     */
     bool pawn_promotion_available(int x, int y);
     bool pawn_promotion_available(Vector v);
@@ -98,13 +128,14 @@ public:
     bool promote_pawn(string piece_id, PieceType promote_to);
 
     /*
-     * Undo the last move added to the moves history. Note that this does not return any data, and it destroys the last move (deallocate memory).
-     * Thus if the data for the last move is needed, it should be retrieved and dealt with before calling undo_move()
+     * Undo the last move added to the moves history. Note that this does not return any data, and the last move is removed from the history.
+     * Thus if the data for the last move is needed, it should be retrieved (copied) and dealt with before calling undo_move()
     */
     void undo_move();
 
     /*
      * Returns the move in history given index, where index is 0th index starting from the oldest move added to it
+     * The pointer is only valid until the next move or undo
     */
     Move* peek_history(int index);
     /*
@@ -120,6 +151,12 @@ public:
     */
     void reset_game();
 
+    /*
+     * Sets up the board from a FEN string, clearing the move history. The turn is set from the FEN
+     * Returns false if the FEN could not be parsed (the board is then left empty)
+    */
+    bool load_fen(const string& fen);
+
     // Swap turn to play next move
     void next_turn();
     // Get the current turn's color
@@ -127,6 +164,12 @@ public:
     // Set the current turn's color
     void set_turn(Color color);
 
+    /*
+     * Returns a 64-bit Zobrist key of the current position (piece placement, turn, castling rights, en passant, and pending promotions)
+     * Kept up to date on every move, undo and promotion, so equal positions have equal keys regardless of how they were reached
+    */
+    uint64_t get_key();
+
     ~ChessGame();
 };
 
@@ -3,8 +3,8 @@
 
 void Piece::generate_id() {
     string chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
-    random_device rd;
-    mt19937 rng(rd());
+    // seeding a generator is far slower than drawing from it, and games are set up often while searching in parallel, so each thread seeds one once
+    static thread_local mt19937 rng((random_device())());
     uniform_int_distribution<int> uni(0, chars.size() - 1);
     piece_id = "";
     int id_length = 8;
@@ -0,0 +1,44 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+using std::vector;
+
+/*
+ * Hands out objects of one type by bumping an index into a list of objects, and takes them back all at once by moving the index back,
+ * either to a mark taken earlier or to the start. Both are O(1), so objects must be released in the reverse order they were handed out
+ *
+ * Objects are created the first time the index reaches them and are kept from then on, so once an arena has handed out as many objects
+ * as it will need, it never allocates again. Objects are handed out as they were left, and have to be reinitialized by the caller
+ * Not thread safe: every thread needs an arena of its own
+*/
+template <typename T>
+class Arena {
+private:
+    vector<T*> objects;
+    unsigned used;
+
+public:
+    Arena() : used(0) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    T* allocate() {
+        if (used == objects.size()) objects.push_back(new T());
+        return objects[used++];
+    }
+
+    // Returns a mark to release every object handed out after this call with
+    unsigned mark() const { return used; }
+    void release(unsigned mark) { used = mark; }
+    // Releases every object
+    void reset() { used = 0; }
+
+    ~Arena() {
+        for (unsigned i = 0; i < objects.size(); i++) {
+            delete objects[i];
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "EvalCache.h"
+
+// score bits of empty entries. No evaluation comes anywhere near it
+#define EMPTY_SCORE 0x80000000u
+
+EvalCache::EvalCache(int size_mb) : entries(NULL), num_entries(0), size_mb(0) {
+    resize(size_mb);
+}
+
+void EvalCache::resize(int new_size_mb) {
+    if (new_size_mb < 0) new_size_mb = 0;
+    delete[] entries;
+    entries = NULL;
+    size_mb = new_size_mb;
+    num_entries = 0;
+    if (size_mb > 0) {
+        num_entries = 1;
+        while (num_entries * 2 * sizeof(atomic<uint64_t>) <= (size_t) size_mb * 1024 * 1024) num_entries *= 2;
+        entries = new atomic<uint64_t>[num_entries];
+    }
+    clear();
+}
+
+int EvalCache::get_size_mb() { return size_mb; }
+
+void EvalCache::clear() {
+    for (size_t i = 0; i < num_entries; i++) {
+        entries[i].store(EMPTY_SCORE, std::memory_order_relaxed);
+    }
+}
+
+bool EvalCache::probe(uint64_t key, int& score) const {
+    if (num_entries == 0) return false;
+    uint64_t entry = entries[key & (num_entries - 1)].load(std::memory_order_relaxed);
+    if (entry >> 32 != key >> 32 || (uint32_t) entry == EMPTY_SCORE) return false;
+    score = (int32_t) (uint32_t) entry;
+    return true;
+}
+
+void EvalCache::store(uint64_t key, int score) {
+    if (num_entries == 0) return;
+    entries[key & (num_entries - 1)].store((key >> 32) << 32 | (uint32_t) score, std::memory_order_relaxed);
+}
+
+EvalCache::~EvalCache() {
+    delete[] entries;
+}
@@ -0,0 +1,49 @@
+#ifndef EVAL_CACHE_H
+#define EVAL_CACHE_H
+
+#include "../Board/Bitboard.h"
+#include <cstddef>
+#include <atomic>
+using std::atomic;
+
+#define DEFAULT_EVAL_CACHE_SIZE_MB 2
+
+/*
+ * Fixed size cache of static evaluations, indexed by position Zobrist key (https://www.chessprogramming.org/Evaluation_Hash_Table)
+ * Leaf positions come up again and again across iterations and transpositions, and a lookup is cheaper than evaluating them
+ *
+ * Every entry is a single 64-bit word holding the upper 32 bits of the key and the score, and a new score always replaces the old one,
+ * so the cache is lossy but can be shared by several search threads without locking: a word is written at once and can never be torn.
+ * Only 32 bits of the key are checked, on top of the bits picking the entry, so a lookup could in theory return the score of another position
+ * Sized separately from the transposition table. A size of 0 disables the cache
+*/
+class EvalCache {
+private:
+    atomic<uint64_t>* entries;
+    size_t num_entries;
+    int size_mb;
+
+public:
+    EvalCache(int size_mb = DEFAULT_EVAL_CACHE_SIZE_MB);
+    EvalCache(const EvalCache&) = delete;
+    EvalCache& operator=(const EvalCache&) = delete;
+
+    /*
+     * Reallocates the cache to about size_mb megabytes (rounded down to a power of two number of entries), clearing all entries
+    */
+    void resize(int size_mb);
+    int get_size_mb();
+    // Removes all entries
+    void clear();
+
+    /*
+     * Looks up the position key. Returns true and sets score if found
+     * probe and store can be called from several threads at once. resize and clear cannot be called while searching
+    */
+    bool probe(uint64_t key, int& score) const;
+    void store(uint64_t key, int score);
+
+    ~EvalCache();
+};
+
+#endif
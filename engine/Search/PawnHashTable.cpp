@@ -0,0 +1,30 @@
+#include "PawnHashTable.h"
+
+// every entry starts out as the pawn structure without pawns (key 0), which scores 0
+PawnHashTable::PawnHashTable() : entries(new Entry[PAWN_HASH_ENTRIES]()), hits(0), misses(0) {}
+
+const int* PawnHashTable::probe(const Position& position) {
+    uint64_t key = position.get_pawn_key();
+    Entry& entry = entries[key & (PAWN_HASH_ENTRIES - 1)];
+    if (entry.key == key) {
+        hits++;
+        return entry.scores;
+    }
+    misses++;
+    int scores[Evaluation::NUM_PHASES];
+    Evaluation::evaluate_pawns(position, scores);
+    entry.key = key;
+    for (int phase = 0; phase < Evaluation::NUM_PHASES; phase++) {
+        entry.scores[phase] = scores[phase];
+    }
+    return entry.scores;
+}
+
+void PawnHashTable::reset_stats() {
+    hits = 0;
+    misses = 0;
+}
+
+PawnHashTable::~PawnHashTable() {
+    delete[] entries;
+}
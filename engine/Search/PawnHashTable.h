@@ -0,0 +1,45 @@
+#ifndef PAWN_HASH_TABLE_H
+#define PAWN_HASH_TABLE_H
+
+#include "../Board/Position.h"
+#include <cstddef>
+
+// Number of entries of a pawn hash table (16 bytes each). Must be a power of two
+#define PAWN_HASH_ENTRIES 16384
+
+/*
+ * Small hash table of pawn structure scores (see Evaluation::evaluate_pawns), indexed by pawn key (https://www.chessprogramming.org/Pawn_Hash_Table)
+ * Pawn structure rarely changes between the positions of a search, so nearly every lookup is a hit and pawn evaluation costs almost nothing
+ *
+ * Not thread safe: every search thread has a table of its own. An entry is replaced by whatever pawn structure maps to the same slot next,
+ * and since the full key is checked, a lookup never returns the scores of another pawn structure
+*/
+class PawnHashTable {
+private:
+    struct Entry {
+        uint64_t key;
+        int scores[Evaluation::NUM_PHASES];
+    };
+    Entry* entries;
+    long long hits;
+    long long misses;
+
+public:
+    PawnHashTable();
+    PawnHashTable(const PawnHashTable&) = delete;
+    PawnHashTable& operator=(const PawnHashTable&) = delete;
+
+    /*
+     * Returns the pawn structure scores of the position for each game phase, WHITE's minus BLACK's. On a miss, they are evaluated and stored
+    */
+    const int* probe(const Position& position);
+
+    // Lookups that found (hits) or had to evaluate (misses) the pawn structure since the last reset_stats
+    long long get_hits() const { return hits; }
+    long long get_misses() const { return misses; }
+    void reset_stats();
+
+    ~PawnHashTable();
+};
+
+#endif
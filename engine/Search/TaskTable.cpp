@@ -0,0 +1,63 @@
+#include "TaskTable.h"
+#include <algorithm>
+
+TaskTable::TaskTable() : slots(new Slot[TASK_TABLE_SIZE]), stamp(0) {
+    for (int i = 0; i < TASK_TABLE_SIZE; i++) {
+        slots[i].stamp = 0;
+    }
+    used.reserve(TASK_TABLE_SIZE);
+    clear();
+}
+
+void TaskTable::clear() {
+    used.clear();
+    stamp++;
+    if (stamp == 0) {
+        // the stamp wrapped around, so entries stamped long ago would count as current again
+        for (int i = 0; i < TASK_TABLE_SIZE; i++) {
+            slots[i].stamp = 0;
+        }
+        stamp = 1;
+    }
+}
+
+bool TaskTable::probe(uint64_t key, TTEntry& entry) const {
+    const Slot& slot = slots[key & (TASK_TABLE_SIZE - 1)];
+    if (slot.stamp != stamp || slot.entry.key != key) return false;
+    entry = slot.entry;
+    return true;
+}
+
+void TaskTable::store(uint64_t key, int depth, int bound, int score, uint16_t move) {
+    int index = key & (TASK_TABLE_SIZE - 1);
+    Slot& slot = slots[index];
+    if (slot.stamp != stamp) {
+        slot.stamp = stamp;
+        used.push_back(index);
+    } else if (slot.entry.key == key) {
+        // keep the old best move if this result has none, since it is still the best guess for move ordering
+        if (move == NO_TT_MOVE) move = slot.entry.move;
+    } else if (slot.entry.depth > depth) {
+        return;
+    }
+    slot.entry.key = key;
+    slot.entry.score = score;
+    slot.entry.move = move;
+    slot.entry.depth = depth;
+    slot.entry.bound_generation = bound;
+}
+
+void TaskTable::collect(vector<TTEntry>& entries, unsigned max) const {
+    unsigned start = entries.size();
+    for (unsigned i = 0; i < used.size(); i++) {
+        entries.push_back(slots[used[i]].entry);
+    }
+    if (entries.size() - start > max) {
+        std::stable_sort(entries.begin() + start, entries.end(), [](const TTEntry& e1, const TTEntry& e2) { return e1.depth > e2.depth; });
+        entries.resize(start + max);
+    }
+}
+
+TaskTable::~TaskTable() {
+    delete[] slots;
+}
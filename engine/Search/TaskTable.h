@@ -0,0 +1,50 @@
+#ifndef TASK_TABLE_H
+#define TASK_TABLE_H
+
+#include "TranspositionTable.h"
+#include <vector>
+using std::vector;
+
+#define TASK_TABLE_SIZE 4096
+
+/*
+ * Small transposition table of a single young brothers wait task (see ChessEngine::run_task), holding the results the task searched
+ * itself. A task cannot write to the shared transposition table without making what other tasks find there depend on thread timing,
+ * so it keeps its results here until the owner of its split point takes them over (see collect)
+ *
+ * Not thread safe, and only ever written by the thread running the task. Entries are one per slot, and a result replaces the one in its slot
+ * unless that one was searched deeper. clear is O(1): every entry is stamped with the clear it was stored after, and entries stored
+ * before the last clear count as empty, so the table can be reused by task after task
+*/
+class TaskTable {
+private:
+    struct Slot {
+        TTEntry entry;
+        unsigned stamp;
+    };
+    Slot* slots;
+    unsigned stamp;
+    // slots holding an entry stored since the last clear, in the order they were first filled
+    vector<int> used;
+
+public:
+    TaskTable();
+    TaskTable(const TaskTable&) = delete;
+    TaskTable& operator=(const TaskTable&) = delete;
+
+    // Removes all entries
+    void clear();
+    // Looks up the position key. Returns true and copies the entry if found
+    bool probe(uint64_t key, TTEntry& entry) const;
+    // Stores a search result for the position key, like TranspositionTable::store
+    void store(uint64_t key, int depth, int bound, int score, uint16_t move);
+    /*
+     * Appends the entries stored since the last clear to entries, in the order their slots were filled. If there are more than max,
+     * only the max deepest are appended, deepest first
+    */
+    void collect(vector<TTEntry>& entries, unsigned max) const;
+
+    ~TaskTable();
+};
+
+#endif
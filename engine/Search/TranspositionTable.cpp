@@ -0,0 +1,97 @@
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(int size_mb) : clusters(NULL), num_clusters(0), size_mb(0), generation(0) {
+    resize(size_mb);
+}
+
+void TranspositionTable::resize(int new_size_mb) {
+    if (new_size_mb < 1) new_size_mb = 1;
+    delete[] clusters;
+    size_mb = new_size_mb;
+    num_clusters = 1;
+    while (num_clusters * 2 * sizeof(Cluster) <= (size_t) size_mb * 1024 * 1024) num_clusters *= 2;
+    clusters = new Cluster[num_clusters];
+    clear();
+}
+
+int TranspositionTable::get_size_mb() { return size_mb; }
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < num_clusters; i++) {
+        for (int j = 0; j < TT_CLUSTER_SIZE; j++) {
+            clusters[i].slots[j].check.store(0, std::memory_order_relaxed);
+            clusters[i].slots[j].data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::new_search() { generation = (generation + 1) & 63; }
+
+TTEntry TranspositionTable::unpack(uint64_t key, uint64_t data) {
+    TTEntry entry;
+    entry.key = key;
+    entry.score = (int32_t) (uint32_t) data;
+    entry.move = (uint16_t) (data >> 32);
+    entry.depth = (int8_t) (data >> 48);
+    entry.bound_generation = (uint8_t) (data >> 56);
+    return entry;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Cluster& cluster = cluster_for(key);
+    for (int i = 0; i < TT_CLUSTER_SIZE; i++) {
+        uint64_t data = cluster.slots[i].data.load(std::memory_order_relaxed);
+        uint64_t check = cluster.slots[i].check.load(std::memory_order_relaxed);
+        if ((check ^ data) == key && (data >> 56 & 3) != BOUND_NONE) {
+            entry = unpack(key, data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int bound, int score, uint16_t move) {
+    Cluster& cluster = cluster_for(key);
+    Slot* replace = &cluster.slots[0];
+    TTEntry replace_entry;
+    for (int i = 0; i < TT_CLUSTER_SIZE; i++) {
+        Slot* slot = &cluster.slots[i];
+        uint64_t data = slot->data.load(std::memory_order_relaxed);
+        TTEntry entry = unpack(slot->check.load(std::memory_order_relaxed) ^ data, data);
+        if (i == 0) replace_entry = entry;
+        if (entry.key == key || entry.bound() == BOUND_NONE) {
+            replace = slot;
+            replace_entry = entry;
+            break;
+        }
+        // each search an entry is old counts as 8 plies less depth
+        int age = (generation - entry.generation()) & 63;
+        int replace_age = (generation - replace_entry.generation()) & 63;
+        if (entry.depth - 8 * age < replace_entry.depth - 8 * replace_age) {
+            replace = slot;
+            replace_entry = entry;
+        }
+    }
+    // keep the old best move if this result has none, since it is still the best guess for move ordering
+    if (move == NO_TT_MOVE && replace_entry.key == key) move = replace_entry.move;
+    uint64_t data = pack(score, move, depth, bound | (generation << 2));
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    int used = 0, sampled = 0;
+    for (size_t i = 0; i < num_clusters && i < 1000 / TT_CLUSTER_SIZE; i++) {
+        for (int j = 0; j < TT_CLUSTER_SIZE; j++) {
+            uint64_t data = clusters[i].slots[j].data.load(std::memory_order_relaxed);
+            if ((data >> 56 & 3) != BOUND_NONE && (int) (data >> 58) == generation) used++;
+            sampled++;
+        }
+    }
+    return sampled ? used * 1000 / sampled : 0;
+}
+
+TranspositionTable::~TranspositionTable() {
+    delete[] clusters;
+}
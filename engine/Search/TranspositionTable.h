@@ -0,0 +1,103 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "../Board/Bitboard.h"
+#include <cstddef>
+#include <atomic>
+using std::atomic;
+
+#define DEFAULT_TT_SIZE_MB 16
+#define TT_CLUSTER_SIZE 4
+
+/*
+ * Kind of score stored in a transposition table entry
+ * EXACT scores are the true negamax value, LOWER scores come from a beta cutoff (the value is at least the score),
+ * and UPPER scores come from a node where no move raised alpha (the value is at most the score)
+*/
+enum Bound {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1,
+    BOUND_LOWER = 2,
+    BOUND_EXACT = 3
+};
+
+/*
+ * A transposition table entry, as returned by a probe
+ * The best move is stored as the packed bits of a BoardMove (see Position.h), or NO_TT_MOVE
+*/
+struct TTEntry {
+    uint64_t key;
+    int32_t score;
+    uint16_t move;
+    int8_t depth;
+    // bound in the low 2 bits, search generation in the upper 6
+    uint8_t bound_generation;
+
+    int bound() const { return bound_generation & 3; }
+    int generation() const { return bound_generation >> 2; }
+};
+
+#define NO_TT_MOVE 0
+
+/*
+ * Fixed size hash table of search results, indexed by position Zobrist key (https://www.chessprogramming.org/Transposition_Table)
+ * Entries are grouped in clusters of TT_CLUSTER_SIZE sharing a cache line. When a cluster is full, the entry replaced is the one with the
+ * lowest depth, where entries from older searches count as shallower, so deep and recent results are kept
+ *
+ * The table can be shared by several search threads without locking. Each slot holds the entry data packed into 64 bits, and the key
+ * XORed with that data, so a slot torn by two threads writing at once fails the key check instead of returning another position's data
+ * (https://www.chessprogramming.org/Shared_Hash_Table#Lockless)
+*/
+class TranspositionTable {
+private:
+    struct Slot {
+        atomic<uint64_t> check;
+        atomic<uint64_t> data;
+    };
+    struct Cluster {
+        Slot slots[TT_CLUSTER_SIZE];
+    };
+    Cluster* clusters;
+    size_t num_clusters;
+    int size_mb;
+    // incremented for every new search, so entries from older searches can be replaced first
+    uint8_t generation;
+
+    Cluster& cluster_for(uint64_t key) const { return clusters[key & (num_clusters - 1)]; }
+
+    // data layout: score in bits 0-31, move in 32-47, depth in 48-55, bound and generation in 56-63
+    static uint64_t pack(int score, uint16_t move, int depth, uint8_t bound_generation) {
+        return (uint64_t) (uint32_t) score | (uint64_t) move << 32 | (uint64_t) (uint8_t) depth << 48 | (uint64_t) bound_generation << 56;
+    }
+    static TTEntry unpack(uint64_t key, uint64_t data);
+
+public:
+    TranspositionTable(int size_mb = DEFAULT_TT_SIZE_MB);
+
+    /*
+     * Reallocates the table to about size_mb megabytes (rounded down to a power of two number of clusters), clearing all entries
+    */
+    void resize(int size_mb);
+    int get_size_mb();
+    // Removes all entries
+    void clear();
+    // Marks the start of a new search. Entries from previous searches are kept, but are replaced before ones from this search
+    void new_search();
+
+    /*
+     * Looks up the position key. Returns true and copies the entry if found
+     * probe and store can be called from several threads at once. resize, clear and new_search cannot be called while searching
+    */
+    bool probe(uint64_t key, TTEntry& entry) const;
+    /*
+     * Stores a search result for the position key. depth is the remaining search depth the score was found with
+    */
+    void store(uint64_t key, int depth, int bound, int score, uint16_t move);
+
+    // Returns how full the table is in permille, sampled from the first 1000 clusters (entries from the current search only)
+    int hashfull() const;
+
+    ~TranspositionTable();
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef FIXED_STACK_H
+#define FIXED_STACK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * Stack of at most N elements, all allocated when the stack is created, so that pushing and popping never allocate and pointers to
+ * elements stay valid. Copies get the same capacity, but only the elements in use are copied
+ *
+ * Pushing onto a full stack is a bug in the caller, who is expected to check full() wherever the size is not already bounded. Rather than
+ * writing past the end, the program is aborted with a message
+*/
+template <typename T, int N>
+class FixedStack {
+private:
+    T* items;
+    int count;
+
+public:
+    FixedStack() : items(new T[N]), count(0) {}
+    FixedStack(const FixedStack& other) : items(new T[N]), count(other.count) {
+        for (int i = 0; i < count; i++) {
+            items[i] = other.items[i];
+        }
+    }
+    FixedStack& operator=(const FixedStack& other) {
+        count = other.count;
+        for (int i = 0; i < count; i++) {
+            items[i] = other.items[i];
+        }
+        return *this;
+    }
+
+    void push_back(const T& item) {
+        if (count == N) {
+            fprintf(stderr, "FixedStack: push onto a full stack of %d elements\n", N);
+            abort();
+        }
+        items[count++] = item;
+    }
+    // Removes the last element. The stack must not be empty
+    void pop_back() { count--; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    T& back() { return items[count - 1]; }
+    const T& back() const { return items[count - 1]; }
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+
+    ~FixedStack() { delete[] items; }
+};
+
+#endif
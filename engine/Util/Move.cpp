@@ -1,7 +1,11 @@
 #include "../Pieces/Piece.h"
 #include "Move.h"
 
-Move::Move() : type(MOVE), promote_to(NONE), old_pawn(NULL) {}
+Move::Move()
+    : move_from(Vector()), move_to(Vector())
+    , piece_moved(NULL), piece_replaced(NULL)
+    , type(MOVE), first_move(false)
+    , promote_to(NONE), old_pawn(NULL) {}
 Move::Move(Vector move_from, Vector move_to, Piece* piece_moved, Piece* piece_replaced)
     : move_from(move_from), move_to(move_to)
     , piece_moved(piece_moved), piece_replaced(piece_replaced)
@@ -45,9 +49,11 @@ string Move::as_string() {
     else if (type == QUEENSIDE_CASTLE) return "0-0-0";
     string s = "";
     if (piece_moved->type != PAWN && type != PAWN_PROMOTION) s += (char) piece_moved->type;
-    s += cols[move_from.x] + to_string(move_from.y + 1);
-    s += type == CAPTURE || (type == PAWN_PROMOTION && piece_replaced != NULL) ? "x" : "-";
-    s += cols[move_to.x] + to_string(move_to.y + 1);
+    s += (char) ('a' + move_from.x);
+    s += (char) ('1' + move_from.y);
+    s += type == CAPTURE || type == EN_PASSANT || (type == PAWN_PROMOTION && piece_replaced != NULL) ? "x" : "-";
+    s += (char) ('a' + move_to.x);
+    s += (char) ('1' + move_to.y);
     if (type == PAWN_PROMOTION) s += (char) promote_to;
     return s;
 }
\ No newline at end of file
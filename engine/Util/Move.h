@@ -13,7 +13,8 @@ enum MoveType {
     CAPTURE = 'c',
     CASTLE = 't',
     QUEENSIDE_CASTLE = 'q',
-    PAWN_PROMOTION = 'p'
+    PAWN_PROMOTION = 'p',
+    EN_PASSANT = 'e'
 };
 
 class Piece;
@@ -21,10 +22,11 @@ class Piece;
  * Represents a chess move
  * Stores the position of piece to move from, and the position to where the piece needs to move, as well as pointers to the pieces moved/replaced
  * Does not handle Piece memory
+ *
+ * This is the move of the ChessGame and ChessEngine APIs. Internally, moves are generated, searched and stored as packed 16-bit BoardMoves
+ * (see Position.h), which ChessGame::to_move and ChessGame::to_board_move convert from and to
 */
 class Move {
-private:
-    string cols = "abcdefgh";
 public:
     Vector move_from;
     Vector move_to;
@@ -0,0 +1,191 @@
+/*
+ * Perft command line tool, used to check move generation correctness and measure move generation speed
+ * Build with "make perft", then run "_bin/perft help" for usage
+*/
+
+#include "Perft.h"
+#include "Positions.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+using namespace std;
+
+static const char* start_fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+void print_usage();
+double elapsed_seconds(chrono::steady_clock::time_point start);
+uint64_t nodes_per_second(uint64_t nodes, double seconds);
+uint64_t total_nodes(const vector<PerftDivide>& divide);
+int run_divide(const string& fen, int depth, bool use_api, int threads, PerftHash* hash);
+int run_suite(int max_depth, bool use_api, int threads, PerftHash* hash);
+int run_scaling(const string& fen, int depth, int max_threads, PerftHash* hash);
+
+int main(int argc, char** argv) {
+    int depth = 5;
+    bool depth_given = false;
+    bool use_api = false;
+    bool suite = false;
+    bool scaling = false;
+    int threads = max(1, (int) thread::hardware_concurrency());
+    int hash_mb = 64;
+    string fen = start_fen;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "help" || arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--api") {
+            use_api = true;
+        } else if (arg == "--suite") {
+            suite = true;
+        } else if (arg == "--scaling") {
+            scaling = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hash_mb = max(0, atoi(argv[++i]));
+        } else if (arg.find_first_not_of("0123456789") == string::npos) {
+            depth = atoi(arg.c_str());
+            depth_given = true;
+        } else {
+            fen = arg;
+        }
+    }
+
+    PerftHash* hash = hash_mb > 0 ? new PerftHash(hash_mb) : NULL;
+    int result;
+    if (suite) result = run_suite(depth_given ? depth : 0, use_api, threads, hash);
+    else if (scaling) result = run_scaling(fen, depth, threads, hash);
+    else result = run_divide(fen, depth, use_api, threads, hash);
+    delete hash;
+    return result;
+}
+
+void print_usage() {
+    cout << "Usage: perft [options] [depth] [\"fen\"]\n";
+    cout << "       perft [options] --suite [max depth]\n";
+    cout << "       perft [options] --scaling [depth] [\"fen\"]\n\n";
+    cout << "With a depth and optional FEN (default start position), prints the node count below each root move and the total\n";
+    cout << "--suite runs the reference positions and checks their node counts. Without a max depth, a quick depth is used for each position\n";
+    cout << "--scaling runs the same count with 1, 2, 4, ... up to --threads threads and reports the speedup of each\n\n";
+    cout << "Options:\n";
+    cout << "--threads <n>  number of threads the root moves are split between (default: number of cores)\n";
+    cout << "--hash <mb>    size of the shared node count hash in MB, 0 to disable (default: 64)\n";
+    cout << "--api          count through the ChessGame API instead of the bitboard position directly (much slower, single threaded, no hash)\n";
+}
+
+double elapsed_seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+uint64_t nodes_per_second(uint64_t nodes, double seconds) {
+    return seconds > 0 ? (uint64_t) (nodes / seconds) : 0;
+}
+
+uint64_t total_nodes(const vector<PerftDivide>& divide) {
+    uint64_t total = 0;
+    for (unsigned i = 0; i < divide.size(); i++) {
+        total += divide[i].nodes;
+    }
+    return total;
+}
+
+int run_divide(const string& fen, int depth, bool use_api, int threads, PerftHash* hash) {
+    ChessGame game;
+    if (!game.load_fen(fen)) {
+        cout << "Invalid FEN: " << fen << endl;
+        return 1;
+    }
+    cout << "Position: " << fen << endl;
+    cout << "Depth: " << depth;
+    if (use_api) cout << " (ChessGame API)";
+    else cout << " (" << threads << " thread(s), " << (hash ? "hash" : "no hash") << ")";
+    cout << endl << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<PerftDivide> divide = use_api ? perft_divide_api(game, depth) : perft_divide(game.board->get_position(), depth, threads, hash);
+    double seconds = elapsed_seconds(start);
+
+    uint64_t total = total_nodes(divide);
+    for (unsigned i = 0; i < divide.size(); i++) {
+        cout << divide[i].move << ": " << divide[i].nodes << endl;
+    }
+    cout << endl << "Moves: " << divide.size() << endl;
+    cout << "Nodes: " << total << endl;
+    cout << "Time: " << fixed << setprecision(3) << seconds << " s" << endl;
+    cout << "Nodes/second: " << nodes_per_second(total, seconds) << endl;
+    return 0;
+}
+
+int run_suite(int max_depth, bool use_api, int threads, PerftHash* hash) {
+    int failed = 0;
+    uint64_t suite_nodes = 0;
+    double suite_seconds = 0;
+    for (int p = 0; p < num_perft_positions; p++) {
+        const PerftPosition& position = perft_positions[p];
+        int depth = max_depth > 0 ? max_depth : position.default_depth;
+        ChessGame game;
+        game.load_fen(position.fen);
+        cout << position.name << " (" << position.fen << ")" << endl;
+        for (int d = 1; d <= depth && d <= PERFT_MAX_DEPTH; d++) {
+            uint64_t expected = position.expected[d - 1];
+            if (expected == 0) break;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            uint64_t nodes = use_api ? perft_api(game, d) : total_nodes(perft_divide(game.board->get_position(), d, threads, hash));
+            double seconds = elapsed_seconds(start);
+            suite_nodes += nodes;
+            suite_seconds += seconds;
+            bool passed = nodes == expected;
+            if (!passed) failed++;
+            cout << "  " << (passed ? "PASS" : "FAIL") << " depth " << d << ": " << nodes;
+            if (!passed) cout << " (expected " << expected << ")";
+            cout << ", " << fixed << setprecision(3) << seconds << " s, " << nodes_per_second(nodes, seconds) << " nodes/second" << endl;
+        }
+    }
+    cout << endl << (failed ? "FAILED: " : "All passed: ") << failed << " failure(s), " << suite_nodes << " nodes in "
+        << fixed << setprecision(3) << suite_seconds << " s (" << nodes_per_second(suite_nodes, suite_seconds) << " nodes/second)" << endl;
+    return failed ? 1 : 0;
+}
+
+int run_scaling(const string& fen, int depth, int max_threads, PerftHash* hash) {
+    ChessGame game;
+    if (!game.load_fen(fen)) {
+        cout << "Invalid FEN: " << fen << endl;
+        return 1;
+    }
+    cout << "Position: " << fen << endl;
+    cout << "Depth: " << depth << " (" << (hash ? "hash" : "no hash") << ")" << endl << endl;
+
+    vector<int> thread_counts;
+    for (int t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+
+    uint64_t expected = 0;
+    double single_thread_seconds = 0;
+    bool mismatch = false;
+    for (unsigned i = 0; i < thread_counts.size(); i++) {
+        // every run starts from an empty hash, so they do the same amount of work
+        if (hash) hash->clear();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        uint64_t nodes = total_nodes(perft_divide(game.board->get_position(), depth, thread_counts[i], hash));
+        double seconds = elapsed_seconds(start);
+        if (i == 0) {
+            expected = nodes;
+            single_thread_seconds = seconds;
+        }
+        cout << setw(3) << thread_counts[i] << " thread(s): " << nodes << " nodes, " << fixed << setprecision(3) << seconds << " s, "
+            << nodes_per_second(nodes, seconds) << " nodes/second, speedup " << setprecision(2)
+            << (seconds > 0 ? single_thread_seconds / seconds : 0) << "x";
+        if (nodes != expected) {
+            cout << " (MISMATCH, expected " << expected << ")";
+            mismatch = true;
+        }
+        cout << endl;
+    }
+    return mismatch ? 1 : 0;
+}
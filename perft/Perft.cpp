@@ -0,0 +1,173 @@
+#include "Perft.h"
+#include <cctype>
+#include <thread>
+
+PerftHash::PerftHash(int size_mb) {
+    uint64_t size = 1;
+    while (size * 2 * sizeof(Entry) <= (uint64_t) size_mb * 1024 * 1024) size *= 2;
+    entries = new Entry[size];
+    mask = size - 1;
+    clear();
+}
+
+void PerftHash::clear() {
+    for (uint64_t i = 0; i <= mask; i++) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].nodes.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool PerftHash::probe(uint64_t key, int depth, uint64_t& nodes) const {
+    key = entry_key(key, depth);
+    const Entry& entry = entries[key & mask];
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    uint64_t stored = entry.nodes.load(std::memory_order_relaxed);
+    if ((check ^ stored) != key) return false;
+    nodes = stored;
+    return true;
+}
+
+void PerftHash::store(uint64_t key, int depth, uint64_t nodes) {
+    key = entry_key(key, depth);
+    Entry& entry = entries[key & mask];
+    entry.check.store(key ^ nodes, std::memory_order_relaxed);
+    entry.nodes.store(nodes, std::memory_order_relaxed);
+}
+
+PerftHash::~PerftHash() {
+    delete[] entries;
+}
+
+string move_to_uci(BoardMove m) {
+    string s = "";
+    s += (char) ('a' + square_x(m.from()));
+    s += (char) ('1' + square_y(m.from()));
+    s += (char) ('a' + square_x(m.to()));
+    s += (char) ('1' + square_y(m.to()));
+    if (m.promote_to() != NONE) s += (char) tolower((char) m.promote_to());
+    return s;
+}
+
+uint64_t perft(Position& position, int depth, PerftHash* hash) {
+    if (depth <= 0) return 1;
+    // depth 1 is bulk counted, which is cheaper than a hash lookup
+    uint64_t key = 0;
+    if (hash && depth > 1) {
+        uint64_t nodes;
+        key = position.get_key();
+        if (hash->probe(key, depth, nodes)) return nodes;
+    }
+    MoveList moves;
+    generate_legal_moves(position, color_index(position.get_side()), moves);
+    uint64_t nodes = 0;
+    for (auto m = moves.begin(); m != moves.end(); m++) {
+        int variations = m->flag() == PROMOTION_MOVE ? 4 : 1;
+        // bulk counting: the leaves themselves don't need to be played
+        if (depth == 1) {
+            nodes += variations;
+            continue;
+        }
+        for (int i = 0; i < variations; i++) {
+            BoardMove move = *m;
+            if (move.flag() == PROMOTION_MOVE) move.set_promote_to(promote_to_pieces[i]);
+            position.make_move(move);
+            nodes += perft(position, depth - 1, hash);
+            position.unmake_move();
+        }
+    }
+    if (hash && depth > 1) hash->store(key, depth, nodes);
+    return nodes;
+}
+
+// Searches root moves handed out through next_move until none are left, writing the count for root move i into divide[i]
+static void perft_worker(Position position, const vector<BoardMove>* root_moves, vector<PerftDivide>* divide,
+    atomic<int>* next_move, int depth, PerftHash* hash) {
+    int i;
+    while ((i = next_move->fetch_add(1)) < (int) root_moves->size()) {
+        position.make_move((*root_moves)[i]);
+        (*divide)[i].nodes = perft(position, depth - 1, hash);
+        position.unmake_move();
+    }
+}
+
+vector<PerftDivide> perft_divide(Position& position, int depth, int threads, PerftHash* hash) {
+    MoveList moves;
+    vector<BoardMove> root_moves;
+    generate_legal_moves(position, color_index(position.get_side()), moves);
+    // every promotion piece is a separate root move, so they can go to different threads
+    for (auto m = moves.begin(); m != moves.end(); m++) {
+        int variations = m->flag() == PROMOTION_MOVE ? 4 : 1;
+        for (int i = 0; i < variations; i++) {
+            BoardMove move = *m;
+            if (move.flag() == PROMOTION_MOVE) move.set_promote_to(promote_to_pieces[i]);
+            root_moves.push_back(move);
+        }
+    }
+    vector<PerftDivide> divide(root_moves.size());
+    for (unsigned i = 0; i < root_moves.size(); i++) {
+        divide[i].move = move_to_uci(root_moves[i]);
+    }
+
+    atomic<int> next_move(0);
+    if (threads <= 1) {
+        perft_worker(position, &root_moves, &divide, &next_move, depth, hash);
+        return divide;
+    }
+    vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(std::thread(perft_worker, position, &root_moves, &divide, &next_move, depth, hash));
+    }
+    for (unsigned t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    return divide;
+}
+
+// plays a move (and promotion) through the API, and passes the turn like a front-end would
+static void api_make_move(ChessGame& game, Move m, PieceType promote_to) {
+    game.move_valid(m);
+    if (m.type == PAWN_PROMOTION) game.promote_pawn(m.move_to, promote_to);
+    game.next_turn();
+}
+
+static void api_undo_move(ChessGame& game) {
+    game.undo_move();
+    game.next_turn();
+}
+
+uint64_t perft_api(ChessGame& game, int depth) {
+    if (depth <= 0) return 1;
+    vector<Move> moves = game.get_all_valid_moves();
+    uint64_t nodes = 0;
+    for (auto m = moves.begin(); m != moves.end(); m++) {
+        int variations = m->type == PAWN_PROMOTION ? 4 : 1;
+        if (depth == 1) {
+            nodes += variations;
+            continue;
+        }
+        for (int i = 0; i < variations; i++) {
+            api_make_move(game, *m, promote_to_pieces[i]);
+            nodes += perft_api(game, depth - 1);
+            api_undo_move(game);
+        }
+    }
+    return nodes;
+}
+
+vector<PerftDivide> perft_divide_api(ChessGame& game, int depth) {
+    vector<PerftDivide> divide;
+    vector<Move> moves = game.get_all_valid_moves();
+    for (auto m = moves.begin(); m != moves.end(); m++) {
+        int variations = m->type == PAWN_PROMOTION ? 4 : 1;
+        for (int i = 0; i < variations; i++) {
+            int from = make_square(m->move_from.x, m->move_from.y), to = make_square(m->move_to.x, m->move_to.y);
+            PerftDivide d;
+            d.move = move_to_uci(m->type == PAWN_PROMOTION ? BoardMove(from, to, PROMOTION_MOVE, promote_to_pieces[i]) : BoardMove(from, to));
+            api_make_move(game, *m, promote_to_pieces[i]);
+            d.nodes = perft_api(game, depth - 1);
+            api_undo_move(game);
+            divide.push_back(d);
+        }
+    }
+    return divide;
+}
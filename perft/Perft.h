@@ -0,0 +1,72 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "../engine/Game.h"
+#include <cstdint>
+#include <atomic>
+using std::atomic;
+
+/*
+ * Move generation test functions (https://www.chessprogramming.org/Perft)
+ * Counts the leaf nodes of the legal move tree to a given depth. Every pending pawn promotion counts as four moves, one per promotion piece
+*/
+
+/*
+ * Hash table of subtree node counts, keyed by position key and remaining depth
+ * Shared by all perft threads without locking: each entry stores its key XORed with its node count, so an entry torn by two threads
+ * writing at once fails the key check on probe instead of returning a wrong count (https://www.chessprogramming.org/Shared_Hash_Table)
+*/
+class PerftHash {
+private:
+    struct Entry {
+        atomic<uint64_t> check;
+        atomic<uint64_t> nodes;
+    };
+    Entry* entries;
+    uint64_t mask;
+
+    // mixes the remaining depth into the position key, so the same position at different depths gets different entries
+    static uint64_t entry_key(uint64_t key, int depth) { return key ^ (depth * 0x9E3779B97F4A7C15ULL); }
+
+public:
+    // Allocates a table of about size_mb megabytes (rounded down to a power of two number of entries)
+    PerftHash(int size_mb);
+
+    void clear();
+    // Returns true and sets nodes if the position was found at this depth
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const;
+    void store(uint64_t key, int depth, uint64_t nodes);
+
+    ~PerftHash();
+};
+
+/*
+ * Counts leaf nodes on the bitboard position directly. This is what move generation throughput is measured with
+ * If a hash is given, subtree counts are stored in and reused from it
+*/
+uint64_t perft(Position& position, int depth, PerftHash* hash = NULL);
+/*
+ * Counts leaf nodes going through the ChessGame API (get_all_valid_moves, move_valid, promote_pawn, undo_move)
+ * Much slower, but checks that the API layer agrees with the position
+*/
+uint64_t perft_api(ChessGame& game, int depth);
+
+// Node count below a single root move
+struct PerftDivide {
+    string move;
+    uint64_t nodes;
+};
+
+/*
+ * Same as perft/perft_api, but returns the node count below each root move
+ * perft_divide splits the root moves between the given number of threads, each searching its own copy of the position
+*/
+vector<PerftDivide> perft_divide(Position& position, int depth, int threads = 1, PerftHash* hash = NULL);
+vector<PerftDivide> perft_divide_api(ChessGame& game, int depth);
+
+/*
+ * Returns move in long algebraic (UCI) notation, e.g. e2e4 or e7e8q
+*/
+string move_to_uci(BoardMove m);
+
+#endif
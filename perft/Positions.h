@@ -0,0 +1,54 @@
+#ifndef PERFT_POSITIONS_H
+#define PERFT_POSITIONS_H
+
+#include <cstdint>
+
+#define PERFT_MAX_DEPTH 7
+
+/*
+ * Reference positions with known perft results
+ * Positions and counts from https://www.chessprogramming.org/Perft_Results
+*/
+struct PerftPosition {
+    const char* name;
+    const char* fen;
+    // depth used when running the suite without a depth limit, so the whole suite finishes in a few seconds
+    int default_depth;
+    // expected[d - 1] is the node count at depth d, 0 if unknown
+    uint64_t expected[PERFT_MAX_DEPTH];
+};
+
+static const PerftPosition perft_positions[] = {
+    {
+        "start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+        { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860ULL }
+    },
+    {
+        "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+        { 48, 2039, 97862, 4085603, 193690690, 8031647685ULL, 0 }
+    },
+    {
+        "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5,
+        { 14, 191, 2812, 43238, 674624, 11030083, 178633661 }
+    },
+    {
+        "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4,
+        { 6, 264, 9467, 422333, 15833292, 706045033, 0 }
+    },
+    {
+        "position 4 mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 4,
+        { 6, 264, 9467, 422333, 15833292, 706045033, 0 }
+    },
+    {
+        "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4,
+        { 44, 1486, 62379, 2103487, 89941194, 0, 0 }
+    },
+    {
+        "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+        { 46, 2079, 89890, 3894594, 164075551, 6923051137ULL, 0 }
+    },
+};
+
+static const int num_perft_positions = sizeof(perft_positions) / sizeof(perft_positions[0]);
+
+#endif
@@ -62,7 +62,15 @@ extern "C" {
     EMSCRIPTEN_KEEPALIVE
     bool engine_set_level(char* engine_id, int new_level);
     EMSCRIPTEN_KEEPALIVE
-    int* engine_generate_move(char* engine_id, char* game_id, char color);
+    int engine_get_hash_size(char* engine_id);
+    EMSCRIPTEN_KEEPALIVE
+    bool engine_set_hash_size(char* engine_id, int size_mb);
+    EMSCRIPTEN_KEEPALIVE
+    int engine_get_eval_cache_size(char* engine_id);
+    EMSCRIPTEN_KEEPALIVE
+    bool engine_set_eval_cache_size(char* engine_id, int size_mb);
+    EMSCRIPTEN_KEEPALIVE
+    int* engine_generate_move(char* engine_id, char* game_id, char color, int time_ms, int max_nodes, int max_depth);
     EMSCRIPTEN_KEEPALIVE
     int engine_get_number_moves(char* engine_id);
     EMSCRIPTEN_KEEPALIVE
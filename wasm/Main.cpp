@@ -281,18 +281,54 @@ bool engine_set_level(char* engine_id, int new_level) {
     return false;
 }
 
-// Returns generated move in array format: [moveFromX, moveFromY, moveToX, moveToY, movesConsidered]
-int* engine_generate_move(char* engine_id, char* game_id, char color) {
+// If specified engine exists, return its transposition table size in MB. If it doesn't return -1
+int engine_get_hash_size(char* engine_id) {
+    if (is_valid_engine(engine_id)) {
+        return engines.at(engine_id)->get_hash_size();
+    }
+    return -1;
+}
+
+// Returns true if engine exists and success, false if engine doesn't exists
+bool engine_set_hash_size(char* engine_id, int size_mb) {
+    if (is_valid_engine(engine_id)) {
+        engines.at(engine_id)->set_hash_size(size_mb);
+        return true;
+    }
+    return false;
+}
+
+// If specified engine exists, return its evaluation cache size in MB. If it doesn't return -1
+int engine_get_eval_cache_size(char* engine_id) {
+    if (is_valid_engine(engine_id)) {
+        return engines.at(engine_id)->get_eval_cache_size();
+    }
+    return -1;
+}
+
+// Returns true if engine exists and success, false if engine doesn't exists
+bool engine_set_eval_cache_size(char* engine_id, int size_mb) {
+    if (is_valid_engine(engine_id)) {
+        engines.at(engine_id)->set_eval_cache_size(size_mb);
+        return true;
+    }
+    return false;
+}
+
+// Returns generated move in array format: [moveFromX, moveFromY, moveToX, moveToY, movesConsidered, promoteTo, depthReached]
+// time_ms, max_nodes and max_depth limit the search (0 for no limit), on top of the engine level
+int* engine_generate_move(char* engine_id, char* game_id, char color, int time_ms, int max_nodes, int max_depth) {
     if (is_valid_engine(engine_id) && is_valid_game(game_id) && is_valid_color(color)) {
         ChessEngine* engine = engines.at(engine_id);
-        Move move = engine->generate_move(color_from_char(color), games.at(game_id));
-        int* arr = (int*) malloc(sizeof(int) * 6);
+        Move move = engine->generate_move(color_from_char(color), games.at(game_id), SearchLimits(max_depth, time_ms, max_nodes));
+        int* arr = (int*) malloc(sizeof(int) * 7);
         arr[0] = move.move_from.x;
         arr[1] = move.move_from.y;
         arr[2] = move.move_to.x;
         arr[3] = move.move_to.y;
         arr[4] = engine->get_moves_considered();
         arr[5] = (char) move.promote_to;
+        arr[6] = engine->get_depth_reached();
         return arr;
     }
     return 0;
@@ -231,17 +231,36 @@ class ChessEngine {
         return Module._engine_set_level(this._engineIdAddress, newLevel)
     }
 
-    generateMove(game, color) {
-        const address = Module._engine_generate_move(this._engineIdAddress, game._gameIdAddress, color)
+    getHashSize() {
+        return Module._engine_get_hash_size(this._engineIdAddress)
+    }
+
+    setHashSize(sizeMb) {
+        return Module._engine_set_hash_size(this._engineIdAddress, sizeMb)
+    }
+
+    getEvalCacheSize() {
+        return Module._engine_get_eval_cache_size(this._engineIdAddress)
+    }
+
+    setEvalCacheSize(sizeMb) {
+        return Module._engine_set_eval_cache_size(this._engineIdAddress, sizeMb)
+    }
+
+    generateMove(game, color, limits = {}) {
+        const address = Module._engine_generate_move(
+            this._engineIdAddress, game._gameIdAddress, color, limits.timeMs || 0, limits.nodes || 0, limits.depth || 0
+        )
         if (address == 0) return null
-        const arr = intArrayFromMemory(address, 6)
+        const arr = intArrayFromMemory(address, 7)
         let move = {
             x: arr[0],
             y: arr[1],
             x2: arr[2],
             y2: arr[3],
             movesConsidered: arr[4],
-            promoteTo: String.fromCharCode(arr[5])
+            promoteTo: String.fromCharCode(arr[5]),
+            depthReached: arr[6]
         }
         return move
     }